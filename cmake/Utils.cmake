@@ -18,14 +18,12 @@ function(setup_project)
             -Wextra
             -Wpedantic
     )
-
-    enable_testing()
 endfunction()
 
 function(add_lab LAB_NUM)
     # Parsing arguments
 
-    cmake_parse_arguments(ARG "" "" "CLI_SOURCES;LIB_SOURCES;TEST_SOURCES" ${ARGN})
+    cmake_parse_arguments(ARG "" "" "CLI_SOURCES;LIB_SOURCES;TEST_SOURCES;PERF_SOURCES" ${ARGN})
 
     set(LAB${LAB_NUM}_CLI_SOURCES)
     foreach(SOURCE ${ARG_CLI_SOURCES})
@@ -51,6 +49,14 @@ function(add_lab LAB_NUM)
         )
     endforeach()
 
+    set(LAB${LAB_NUM}_PERF_SOURCES)
+    foreach(SOURCE ${ARG_PERF_SOURCES})
+        list(APPEND
+                LAB${LAB_NUM}_PERF_SOURCES
+                ${TESTS_DIR}/${SOURCE}
+        )
+    endforeach()
+
     # Adding library
 
     if (LAB${LAB_NUM}_LIB_SOURCES)
@@ -110,4 +116,43 @@ function(add_lab LAB_NUM)
             NAME lab${LAB_NUM}_tests
             COMMAND lab${LAB_NUM}_test
     )
+
+    # Adding performance tests
+
+    if (LAB${LAB_NUM}_PERF_SOURCES)
+        add_executable(lab${LAB_NUM}_perf_test
+                ${LAB${LAB_NUM}_PERF_SOURCES}
+        )
+
+        target_include_directories(lab${LAB_NUM}_perf_test
+                PRIVATE
+                GTest::GTest
+                ${INCLUDE_DIR}
+        )
+
+        target_link_libraries(lab${LAB_NUM}_perf_test
+                PRIVATE
+                GTest::GTest
+        )
+
+        if (LAB${LAB_NUM}_LIB_SOURCES)
+            target_link_libraries(lab${LAB_NUM}_perf_test
+                    PRIVATE
+                    lab${LAB_NUM}_lib
+            )
+        endif()
+
+        # Baselines are machine-specific timings, so they only run on request.
+        # Every scenario is a separate test process, so its peak memory is its own
+        if (LAB_PERF_TESTS)
+            include(GoogleTest)
+
+            gtest_discover_tests(lab${LAB_NUM}_perf_test
+                    TEST_PREFIX lab${LAB_NUM}_perf.
+                    PROPERTIES
+                    LABELS perf
+                    RUN_SERIAL TRUE
+            )
+        endif()
+    endif()
 endfunction()
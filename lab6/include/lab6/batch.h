@@ -0,0 +1,83 @@
+#ifndef MAI_OOP_2025_BATCH_H
+#define MAI_OOP_2025_BATCH_H
+
+#include <array>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <lab6/game.h>
+
+
+struct ScenarioParameters {
+    std::size_t npcs;
+    double distance;
+};
+
+/**
+ * Fills an empty game with a world for the given parameters. Must draw all
+ * randomness from the passed engine, so every game is reproducible.
+ */
+using ScenarioGenerator = std::function<void(Game &game,
+                                             const ScenarioParameters &parameters,
+                                             std::mt19937_64 &random)>;
+
+/**
+ * NPCs of uniformly random types scattered uniformly over the world.
+ */
+auto GenerateUniformScenario(Game &game,
+                             const ScenarioParameters &parameters,
+                             std::mt19937_64 &random) -> void;
+
+struct SurvivalStats {
+    std::array<std::uint64_t, NPC_TYPES_COUNT> spawned {};
+    std::array<std::uint64_t, NPC_TYPES_COUNT> survived {};
+
+    auto GetSurvivalRate(NPCType type) const -> double;
+
+    auto Merge(const SurvivalStats &other) -> void;
+};
+
+struct BatchResult {
+    ScenarioParameters parameters;
+    std::uint64_t games;
+    SurvivalStats stats;
+};
+
+struct BatchReport {
+    // One result per parameter set, in grid order
+    std::vector<BatchResult> results;
+    std::uint64_t games;
+    double seconds;
+
+    auto GetGamesPerSecond() const -> double;
+};
+
+/**
+ * Runs independent games for every set of a parameter grid on a pool of
+ * work-stealing workers. Every worker reuses one Game with its own factory,
+ * whose names are cleared between games, so generators may use any names.
+ * Battles produce no dumps or observer output, and only survival statistics
+ * are kept. Game i of the batch is seeded with seed + i, so the report does
+ * not depend on the number of workers or on scheduling.
+ */
+class BatchRunner final {
+public:
+
+    explicit BatchRunner(ScenarioGenerator generator = GenerateUniformScenario,
+                         std::size_t workers = 0);
+
+public:
+
+    auto Run(const std::vector<ScenarioParameters> &grid,
+             std::size_t gamesPerSet,
+             std::uint64_t seed) const -> BatchReport;
+
+private:
+
+    ScenarioGenerator _generator;
+
+    std::size_t _workers;
+};
+
+#endif //MAI_OOP_2025_BATCH_H
@@ -0,0 +1,51 @@
+#ifndef MAI_OOP_2025_BATTLE_CHECKPOINT_H
+#define MAI_OOP_2025_BATTLE_CHECKPOINT_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <lab6/metric.h>
+
+
+struct KillRecord {
+    std::uint32_t attacker;
+    std::uint32_t defender;
+};
+
+/**
+ * Progress of a battle. Defenders before `defender` are evaluated, `kills`
+ * holds what they found in defender order as world indices, and the first
+ * `notified` kills have been delivered to observers. `world` fingerprints
+ * the NPCs and rules the battle started with.
+ *
+ * A checkpoint file has the lines "checkpoint <metric> <bound> <npcs> <world>",
+ * "cursor <defender> <notified>", "kills <count>" and one "<attacker> <defender>"
+ * line per kill.
+ */
+struct BattleCheckpoint {
+    MetricKind metric;
+    std::uint64_t bound;
+    std::uint64_t npcs;
+    std::uint64_t world;
+
+    std::size_t defender;
+    std::size_t notified;
+    std::vector<KillRecord> kills;
+
+    auto Save(std::ostream &ostream) const -> void;
+
+    /**
+     * Writes a temporary file first and renames it over `filename`, so an
+     * interrupted save leaves the previous checkpoint intact.
+     */
+    auto SaveFile(const std::string &filename) const -> int32_t;
+
+    static auto Load(std::istream &istream) -> BattleCheckpoint;
+
+    static auto LoadFile(const std::string &filename) -> BattleCheckpoint;
+};
+
+#endif //MAI_OOP_2025_BATTLE_CHECKPOINT_H
@@ -0,0 +1,58 @@
+#ifndef MAI_OOP_2025_BATTLE_RULES_H
+#define MAI_OOP_2025_BATTLE_RULES_H
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <string>
+
+#include <lab6/npc.h>
+
+
+/**
+ * Kill rules as a dense bitmask matrix indexed by NPCType: bit d of
+ * row a is set when an attacker of type a kills a defender of type d.
+ *
+ * A rules file has one rule per line, "<attacker> <defender> kills|spares",
+ * e.g. "Werewolf Druid kills". Blank lines and lines starting with '#' are
+ * skipped. Pairs that are not listed keep the default rules.
+ */
+class BattleRules final {
+public:
+
+    BattleRules();
+
+public:
+
+    static auto Load(std::istream &istream) -> BattleRules;
+
+    static auto LoadFile(const std::string &filename) -> BattleRules;
+
+public:
+
+    auto Set(NPCType attacker,
+             NPCType defender,
+             bool kills) -> void;
+
+public:
+
+    auto CanKill(NPCType attacker,
+                 NPCType defender) const -> bool {
+        return (_victims[static_cast<std::size_t>(attacker)] >> static_cast<std::size_t>(defender)) & 1U;
+    }
+
+    /**
+     * Bitmask of the attacker types that kill the given defender type.
+     */
+    auto GetAttackers(NPCType defender) const -> std::uint32_t {
+        return _attackers[static_cast<std::size_t>(defender)];
+    }
+
+private:
+
+    std::array<std::uint32_t, NPC_TYPES_COUNT> _victims;
+
+    std::array<std::uint32_t, NPC_TYPES_COUNT> _attackers;
+};
+
+#endif //MAI_OOP_2025_BATTLE_RULES_H
@@ -1,45 +1,219 @@
 #ifndef MAI_OOP_2025_GAME_H
 #define MAI_OOP_2025_GAME_H
 
+#include <functional>
+#include <future>
+#include <ostream>
+#include <utility>
 #include <vector>
 
+#include <lab6/battle_checkpoint.h>
+#include <lab6/battle_rules.h>
 #include <lab6/npc.h>
 #include <lab6/observer.h>
+#include <lab6/spatial_index.h>
+#include <lab6/subscription_index.h>
 
 
+using CheckpointHandler = std::function<void(const BattleCheckpoint &checkpoint)>;
+
 class Game final {
 public:
 
-    explicit Game(NPCFactoryPtr factory);
+    static constexpr std::size_t LOAD_CHUNK_SIZE = 1 << 20;
+
+    static constexpr std::size_t SAVE_CHUNK_SIZE = 1 << 16;
+
+public:
+
+    explicit Game(NPCFactoryPtr factory,
+                  BattleRules rules = BattleRules());
+
+    /**
+     * Releases the names of the remaining NPCs in the factory's name table.
+     */
+    ~Game();
 
 public:
 
     auto StartBattle(double distance) -> int32_t;
 
+    /**
+     * Battle with range checks under the given metric policy
+     * (EuclideanMetric, ManhattanMetric or ChebyshevMetric).
+     */
+    template<typename Metric>
+    auto StartBattle(double distance) -> int32_t;
+
+    /**
+     * Makes battles call the handler with their progress every `interval`
+     * defenders evaluated and every `interval` kills notified. An interval
+     * of 0 turns checkpoints off.
+     */
+    auto SetCheckpointHandler(CheckpointHandler handler,
+                              std::size_t interval) -> void;
+
+    /**
+     * Finishes a battle from a checkpoint, notifying only the kills it has
+     * not notified yet. The game must hold the NPCs and rules the battle
+     * started with, e.g. loaded from a save made before it; returns 1 otherwise.
+     */
+    auto ResumeBattle(const BattleCheckpoint &checkpoint) -> int32_t;
+
     auto AddNPC(NPCType type,
                 Point point,
-                const std::string &name) -> int32_t;
+                std::string_view name) -> int32_t;
+
+    /**
+     * Saves the NPCs as DumpObjects does. The text is formatted by `workers`
+     * threads (0 picks a count from the world size and the hardware).
+     */
+    auto SaveObjects(const std::string &filename,
+                     std::size_t workers = 0) const -> int32_t;
+
+    /**
+     * Saves a snapshot of the current NPCs in the background, so the game
+     * can be changed while the file is written.
+     */
+    auto SaveObjectsAsync(const std::string &filename) const -> std::future<int32_t>;
+
+    /**
+     * Loads NPCs saved by SaveObjects. The file is split into newline-aligned
+     * chunks that `workers` threads (0 picks a count from the file size and
+     * the hardware) parse, create NPCs for and index; only duplicate names are
+     * checked on one thread. The result is the same as loading line by line.
+     * Returns 1 if the file can't be opened or loading stopped at a name longer
+     * than the factory accepts, after loading the NPCs before it.
+     */
+    auto LoadObjects(const std::string &filename,
+                     std::size_t workers = 0) -> int32_t;
+
+    auto DumpObjects(std::ostream &ostream,
+                     std::size_t workers = 0) const -> void;
+
+    /**
+     * Stream StartBattle dumps the world to before and after a battle,
+     * std::cout by default. nullptr turns the dumps off.
+     */
+    auto SetDumpStream(std::ostream *ostream) -> void;
+
+    /**
+     * Removes all NPCs but keeps the allocated storage for the next world.
+     * Names of the game's NPCs, removed by Clear or killed in a battle, are
+     * released in the factory's name table, so their ids may be reused.
+     */
+    auto Clear() -> void;
+
+    auto CountNPCs(NPCType type) const -> std::size_t;
+
+    /**
+     * World generation, bumped by every change of the NPC population.
+     */
+    auto GetGeneration() const -> std::uint64_t;
+
+    /**
+     * Subscribes the observer to the kills matching the filter, all kills by
+     * default. Every observer is told when a battle ends.
+     */
+    auto AddObserver(const ObserverPtr &observer,
+                     const ObserverFilter &filter = ObserverFilter()) -> void;
+
+    auto GetRules() const -> const BattleRules &;
+
+    /**
+     * Name of an NPC created by the game's factory.
+     */
+    auto GetName(const NPC &npc) const -> std::string_view;
+
+    auto GetBounds() const -> const WorldBounds &;
+
+public:
 
-    auto SaveObjects(const std::string &filename) const -> int32_t;
+    auto QueryRect(Point min,
+                   Point max) const -> std::vector<const NPC *>;
 
-    auto LoadObjects(const std::string &filename) -> int32_t;
+    auto QueryRadius(Point center,
+                     double radius) const -> std::vector<const NPC *>;
 
-    auto DumpObjects(std::ostream &ostream) const -> void;
+    auto QueryKNearest(Point center,
+                       std::size_t count) const -> std::vector<const NPC *>;
 
-    auto AddObserver(const ObserverPtr &observer) -> void;
+public:
 
     auto NotifyKill(const NPC &killer,
                     const NPC &killed) -> void;
 
 private:
 
+    /**
+     * Runs a battle on from its state: evaluates the remaining defenders,
+     * then applies and notifies the kills, compacts the world and dumps it.
+     */
+    template<typename Metric>
+    auto RunBattle(BattleCheckpoint &state,
+                   std::size_t known,
+                   bool withinStable) -> int32_t;
+
+    /**
+     * Finds the kills of the remaining defenders in defender order without applying them.
+     */
+    template<typename Metric>
+    auto EvaluatePairs(BattleCheckpoint &state,
+                       std::uint64_t reach,
+                       std::size_t known,
+                       bool withinStable) const -> void;
+
+    auto GetFingerprint() const -> std::uint64_t;
+
     auto AppendNPC(const NPCPtr &npc) -> int32_t;
 
+    /**
+     * Marks a name with a fresh reference as taken, or releases the
+     * reference and returns false when an NPC of the game has it already.
+     */
+    auto TakeName(NameId name) -> bool;
+
+    auto NotifyBattleEnd() -> void;
+
+    auto RebuildIndex(std::uint64_t cellSize) -> void;
+
+    static auto FormatRecord(const NPCRecord &record,
+                             std::string &buffer) -> void;
+
+    template<typename Source>
+    static auto WriteRecords(std::ostream &ostream,
+                             std::size_t count,
+                             std::size_t workers,
+                             Source &&source) -> void;
+
+    static auto ReachRect(Point center,
+                          std::uint64_t reach) -> std::pair<Point, Point>;
+
+    auto ToNPCs(std::vector<std::uint32_t> indices) const -> std::vector<const NPC *>;
+
 private:
 
     std::vector<NPCPtr> _npcs;
+    // Per name id, whether an NPC of the game has that name
+    std::vector<bool> _names;
+    // One spatial index per NPCType
+    std::vector<SpatialIndex> _indices;
     NPCFactoryPtr _npcFactory;
     std::vector<ObserverPtr> _observers;
+    SubscriptionIndex _subscriptions;
+    BattleRules _rules;
+    std::ostream *_dumpStream;
+    CheckpointHandler _checkpointHandler;
+    std::size_t _checkpointInterval;
+
+    std::uint64_t _generation;
+
+    // Range bound under _stableMetric the world of _stableGeneration is known to survive.
+    // NPCs appended later go after the first _stableCount ones, which stay stable
+    std::uint64_t _stableGeneration;
+    MetricKind _stableMetric;
+    std::uint64_t _stableBound;
+    std::size_t _stableCount;
 };
 
 #endif //MAI_OOP_2025_GAME_H
\ No newline at end of file
@@ -0,0 +1,144 @@
+#ifndef MAI_OOP_2025_METRIC_H
+#define MAI_OOP_2025_METRIC_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <lab6/point.h>
+
+
+constexpr double RANGE_EPSILON = 1e-9;
+
+enum class MetricKind {
+    Euclidean,
+    Manhattan,
+    Chebyshev
+};
+
+inline auto AbsDifference(std::uint64_t first,
+                          std::uint64_t second) -> std::uint64_t {
+    return first > second ? first - second : second - first;
+}
+
+/**
+ * Distance metric policies for range checks. Distance() is an integer
+ * measure that grows with the real distance, ToReal() converts it back
+ * for comparison with a user distance, and Reach() is the largest
+ * per-axis offset a measure can have.
+ */
+struct EuclideanMetric {
+    static constexpr MetricKind KIND = MetricKind::Euclidean;
+
+    static constexpr std::uint64_t MAX_DISTANCE = 2 * COORDINATE_LIMIT * COORDINATE_LIMIT;
+
+    static auto Distance(Point first,
+                         Point second) -> std::uint64_t {
+        auto dist_x = AbsDifference(first.GetX(), second.GetX());
+        auto dist_y = AbsDifference(first.GetY(), second.GetY());
+
+        return dist_x * dist_x + dist_y * dist_y;
+    }
+
+    static auto ToReal(std::uint64_t distance) -> double {
+        return std::sqrt(static_cast<double>(distance));
+    }
+
+    static auto Reach(std::uint64_t distance) -> std::uint64_t {
+        auto reach = static_cast<std::uint64_t>(std::sqrt(static_cast<double>(distance)));
+
+        while (reach * reach > distance) {
+            --reach;
+        }
+
+        while ((reach + 1) * (reach + 1) <= distance) {
+            ++reach;
+        }
+
+        return reach;
+    }
+};
+
+struct ManhattanMetric {
+    static constexpr MetricKind KIND = MetricKind::Manhattan;
+
+    static constexpr std::uint64_t MAX_DISTANCE = 2 * COORDINATE_LIMIT;
+
+    static auto Distance(Point first,
+                         Point second) -> std::uint64_t {
+        auto dist_x = AbsDifference(first.GetX(), second.GetX());
+        auto dist_y = AbsDifference(first.GetY(), second.GetY());
+
+        return dist_x + dist_y;
+    }
+
+    static auto ToReal(std::uint64_t distance) -> double {
+        return static_cast<double>(distance);
+    }
+
+    static auto Reach(std::uint64_t distance) -> std::uint64_t {
+        return distance;
+    }
+};
+
+struct ChebyshevMetric {
+    static constexpr MetricKind KIND = MetricKind::Chebyshev;
+
+    static constexpr std::uint64_t MAX_DISTANCE = COORDINATE_LIMIT;
+
+    static auto Distance(Point first,
+                         Point second) -> std::uint64_t {
+        auto dist_x = AbsDifference(first.GetX(), second.GetX());
+        auto dist_y = AbsDifference(first.GetY(), second.GetY());
+
+        return std::max(dist_x, dist_y);
+    }
+
+    static auto ToReal(std::uint64_t distance) -> double {
+        return static_cast<double>(distance);
+    }
+
+    static auto Reach(std::uint64_t distance) -> std::uint64_t {
+        return distance;
+    }
+};
+
+template<typename Metric>
+auto InRange(std::uint64_t measure,
+             double distance) -> bool {
+    return (distance - Metric::ToReal(measure)) > RANGE_EPSILON;
+}
+
+/**
+ * Exclusive integer bound equivalent to InRange: a measure is in range
+ * exactly when it is less than the bound, and 0 means nothing is in range.
+ * Computed once per battle, so the pair loop never touches floating point.
+ */
+template<typename Metric>
+auto RangeBound(double distance) -> std::uint64_t {
+    if (!InRange<Metric>(0, distance)) {
+        return 0;
+    }
+
+    if (InRange<Metric>(Metric::MAX_DISTANCE, distance)) {
+        return Metric::MAX_DISTANCE + 1;
+    }
+
+    // InRange is monotone: true for [0, low], false for [high, MAX_DISTANCE]
+    std::uint64_t low = 0, high = Metric::MAX_DISTANCE;
+
+    while (high - low > 1) {
+        auto middle = low + (high - low) / 2;
+
+        if (InRange<Metric>(middle, distance)) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return high;
+}
+
+#endif //MAI_OOP_2025_METRIC_H
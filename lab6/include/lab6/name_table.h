@@ -0,0 +1,167 @@
+#ifndef MAI_OOP_2025_NAME_TABLE_H
+#define MAI_OOP_2025_NAME_TABLE_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+
+using NameId = std::uint32_t;
+
+/**
+ * Longest name a NameTable can store, set at build time with LAB6_MAX_NAME_LENGTH.
+ */
+#ifndef LAB6_MAX_NAME_LENGTH
+#define LAB6_MAX_NAME_LENGTH 31
+#endif
+
+constexpr std::size_t MAX_NAME_LENGTH = LAB6_MAX_NAME_LENGTH;
+
+static_assert(MAX_NAME_LENGTH <= UINT8_MAX, "FixedName keeps its length in one byte");
+
+/**
+ * Name kept inline in a fixed-capacity buffer, without heap memory.
+ */
+class FixedName final {
+public:
+
+    FixedName();
+
+    explicit FixedName(std::string_view name);
+
+public:
+
+    auto GetView() const -> std::string_view;
+
+private:
+
+    std::array<char, MAX_NAME_LENGTH> _data;
+
+    std::uint8_t _size;
+};
+
+/**
+ * Interning table for NPC names. Every distinct name is stored once
+ * and referred to by a 32-bit id, so name equality is an integer compare.
+ * Every Intern takes a reference to the name and Release drops one; a name
+ * without references is forgotten and its id is handed out again, so ids
+ * stay dense. Text is only needed at the output edge.
+ *
+ * Names are kept as FixedName in blocks of NAMES_PER_BLOCK and looked up
+ * through open-addressing tables of ids, one per shard of name hashes, so
+ * interning only allocates when a block or a table fills up, and different
+ * shards can be filled by different threads.
+ */
+class NameTable final {
+public:
+
+    static constexpr std::size_t NAMES_PER_BLOCK = 1024;
+
+    static constexpr std::size_t SHARDS = 64;
+
+public:
+
+    /**
+     * Names longer than maxLength (at most MAX_NAME_LENGTH) are not accepted.
+     */
+    explicit NameTable(std::size_t maxLength = MAX_NAME_LENGTH);
+
+public:
+
+    auto Intern(std::string_view name) -> NameId;
+
+    /**
+     * Interns names[i], whose Hash is hashes[i], into ids[i] on `workers`
+     * threads, each interning the names of its own shards in order. The result
+     * is that of interning the names one by one, except for which free ids
+     * new names get.
+     */
+    auto InternAll(const std::vector<std::string_view> &names,
+                   const std::vector<std::size_t> &hashes,
+                   std::vector<NameId> &ids,
+                   std::size_t workers) -> void;
+
+    auto Release(NameId id) -> void;
+
+    /**
+     * Forgets all names, keeping the storage. Ids and views handed out so far become invalid.
+     */
+    auto Clear() -> void;
+
+public:
+
+    auto Accepts(std::string_view name) const -> bool;
+
+    auto GetName(NameId id) const -> std::string_view;
+
+    /**
+     * Number of names with references.
+     */
+    auto GetSize() const -> std::size_t;
+
+    auto GetMaxLength() const -> std::size_t;
+
+    static auto Hash(std::string_view name) -> std::size_t;
+
+private:
+
+    struct Shard {
+        // Linear probing over name hashes, at most half full
+        std::vector<NameId> slots;
+        std::size_t size = 0;
+    };
+
+private:
+
+    auto CheckAccepts(std::string_view name) const -> void;
+
+    /**
+     * Slot of the name in its shard, or the empty slot it would take.
+     */
+    auto FindSlot(const Shard &shard,
+                  std::string_view name,
+                  std::size_t hash) const -> std::size_t;
+
+    /**
+     * Makes sure ids up to `count` past the handed out ones have storage.
+     */
+    auto PrepareIds(std::size_t count) -> void;
+
+    auto Store(NameId id,
+               std::string_view name) -> void;
+
+    auto Reserve(Shard &shard,
+                 std::size_t count) -> void;
+
+    auto Rehash(Shard &shard,
+                std::size_t slots) -> void;
+
+    static auto GetShard(std::size_t hash) -> std::size_t;
+
+    static auto GetHomeSlot(const Shard &shard,
+                            std::size_t hash) -> std::size_t;
+
+private:
+
+    static constexpr NameId EMPTY_SLOT = UINT32_MAX;
+
+private:
+
+    std::size_t _maxLength;
+
+    std::size_t _size;
+
+    // Ids handed out so far, and those of them free for reuse
+    std::size_t _ids;
+    std::vector<NameId> _freeIds;
+
+    // Blocks never move, so views of stored names stay valid until they are released
+    std::vector<std::unique_ptr<std::array<FixedName, NAMES_PER_BLOCK>>> _blocks;
+    std::vector<std::uint32_t> _references;
+
+    std::array<Shard, SHARDS> _shards;
+};
+
+#endif //MAI_OOP_2025_NAME_TABLE_H
@@ -3,8 +3,13 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include <lab6/metric.h>
+#include <lab6/name_table.h>
 #include <lab6/point.h>
+#include <lab6/world.h>
 
 
 enum class NPCType {
@@ -13,6 +18,8 @@ enum class NPCType {
     Druid
 };
 
+constexpr std::size_t NPC_TYPES_COUNT = 3;
+
 auto NPCTypeToString(NPCType type) -> std::string_view;
 
 auto StringToNPCType(const std::string &string) -> NPCType;
@@ -22,11 +29,15 @@ class Visitor;
 class NPC;
 using NPCPtr = std::shared_ptr<NPC>;
 
+/**
+ * NPC keeps only the id of its name. The text is resolved through the name
+ * table of the factory that created it, e.g. with Game::GetName.
+ */
 class NPC {
 public:
 
     NPC(Point point,
-        std::string name);
+        NameId name);
 
 public:
 
@@ -43,7 +54,7 @@ public:
 
     auto GetPoint() const -> const Point &;
 
-    auto GetName() const -> const std::string &;
+    auto GetNameId() const -> NameId;
 
     auto GetKilled() const -> bool;
 
@@ -57,7 +68,7 @@ private:
 
     Point _point;
 
-    std::string _name;
+    NameId _name;
 
     bool _killed;
 };
@@ -66,7 +77,7 @@ class Druid final : public NPC {
 public:
 
     Druid(Point point,
-          std::string name);
+          NameId name);
 
 public:
 
@@ -79,7 +90,7 @@ class Squirrel final : public NPC {
 public:
 
     Squirrel(Point point,
-             std::string name);
+             NameId name);
 
 public:
 
@@ -92,7 +103,7 @@ class Werewolf final : public NPC {
 public:
 
     Werewolf(Point point,
-             std::string name);
+             NameId name);
 
 public:
 
@@ -101,20 +112,85 @@ public:
     auto GetType() const -> NPCType override;
 };
 
+/**
+ * One parsed line of a save file. The name views the parsed text.
+ */
+struct NPCRecord {
+    NPCType type;
+    Point point;
+    std::string_view name;
+};
+
 class NPCFactory {
+public:
+
+    /**
+     * NPCs are only created inside the bounds and with names of at most
+     * maxNameLength characters (up to MAX_NAME_LENGTH).
+     */
+    explicit NPCFactory(WorldBounds bounds = WorldBounds(),
+                        std::size_t maxNameLength = MAX_NAME_LENGTH);
+
 public:
 
     virtual ~NPCFactory();
 
 public:
 
-    auto LoadNPC(std::istream &istream) const -> NPCPtr;
+    auto LoadNPC(std::istream &istream) -> NPCPtr;
+
+    /**
+     * Parses a line of a save file without creating the NPC.
+     * Touches no factory state, so it is safe to call from several threads.
+     */
+    auto ParseNPC(std::string_view line) const -> NPCRecord;
 
 public:
 
+    /**
+     * Returns nullptr when the point is out of bounds or the name is too long.
+     */
+    auto CreateNPC(NPCType type,
+                   Point point,
+                   std::string_view name) -> NPCPtr;
+
+    /**
+     * Creates an NPC with a name taken by InternNames, whose reference passes to it.
+     * Checks nothing and touches no factory state, so it is safe to call from several threads.
+     */
     auto CreateNPC(NPCType type,
                    Point point,
-                   const std::string &name) const -> NPCPtr;
+                   NameId name) const -> NPCPtr;
+
+    /**
+     * Takes references to accepted names on `workers` threads, see NameTable::InternAll.
+     */
+    auto InternNames(const std::vector<std::string_view> &names,
+                     const std::vector<std::size_t> &hashes,
+                     std::vector<NameId> &ids,
+                     std::size_t workers) -> void;
+
+    /**
+     * Drops the reference a created NPC holds to its name.
+     */
+    auto ReleaseName(NameId id) -> void;
+
+    /**
+     * Forgets the names of all NPCs created so far, which must no longer be used.
+     */
+    auto ClearNames() -> void;
+
+public:
+
+    auto GetNames() const -> const NameTable &;
+
+    auto GetBounds() const -> const WorldBounds &;
+
+private:
+
+    WorldBounds _bounds;
+
+    NameTable _names;
 };
 
 using NPCFactoryPtr = std::shared_ptr<NPCFactory>;
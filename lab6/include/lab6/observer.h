@@ -1,7 +1,11 @@
 #ifndef MAI_OOP_2025_OBSERVER_H
 #define MAI_OOP_2025_OBSERVER_H
 
+#include <array>
+#include <chrono>
 #include <fstream>
+#include <iostream>
+#include <optional>
 
 #include <lab6/npc.h>
 
@@ -14,16 +18,52 @@ public:
 protected:
 
     auto OnKillMessage(const NPC &iller,
-                       const NPC &killed) -> std::string;
+                       const NPC &killed,
+                       const NameTable &names) -> std::string;
 
 public:
 
+    /**
+     * Names of both NPCs are resolved through `names`.
+     */
     virtual auto OnKill(const NPC &killer,
-                        const NPC &killed) -> void = 0;
+                        const NPC &killed,
+                        const NameTable &names) -> void = 0;
+
+    /**
+     * Called once a battle has resolved all of its kills.
+     */
+    virtual auto OnBattleEnd() -> void;
 };
 
 using ObserverPtr = std::shared_ptr<Observer>;
 
+constexpr std::uint32_t ALL_NPC_TYPES = (1U << NPC_TYPES_COUNT) - 1;
+
+constexpr auto NPCTypeMask(NPCType type) -> std::uint32_t {
+    return 1U << static_cast<std::size_t>(type);
+}
+
+/**
+ * Inclusive rectangle of the world.
+ */
+struct KillRegion {
+    Point min;
+    Point max;
+
+    auto Contains(Point point) const -> bool;
+};
+
+/**
+ * Kills an observer is subscribed to: killer and victim types as NPCTypeMask
+ * bitmasks and, optionally, the region the victim has to be in.
+ */
+struct ObserverFilter {
+    std::uint32_t killers = ALL_NPC_TYPES;
+    std::uint32_t victims = ALL_NPC_TYPES;
+    std::optional<KillRegion> region;
+};
+
 class Logger : public Observer {
 public:
 
@@ -32,18 +72,57 @@ public:
 public:
 
     auto OnKill(const NPC &killer,
-                const NPC &killed) -> void override;
+                const NPC &killed,
+                const NameTable &names) -> void override;
 
 private:
 
     std::ofstream _file;
 };
 
+enum class ScreenMode {
+    // Every kill on its own line
+    Full,
+    // Kill counts by (killer type, victim type) at the end of each battle
+    Summary,
+    // Kill lines, at most a given number per second
+    Sampled
+};
+
 class Screen : public Observer {
+public:
+
+    static constexpr std::size_t DEFAULT_LINES_PER_SECOND = 20;
+
+public:
+
+    explicit Screen(ScreenMode mode = ScreenMode::Summary,
+                    std::size_t linesPerSecond = DEFAULT_LINES_PER_SECOND,
+                    std::ostream &ostream = std::cout);
+
 public:
 
     auto OnKill(const NPC &killer,
-                const NPC &killed) -> void override;
+                const NPC &killed,
+                const NameTable &names) -> void override;
+
+    auto OnBattleEnd() -> void override;
+
+private:
+
+    ScreenMode _mode;
+
+    std::ostream &_ostream;
+
+    std::array<std::array<std::uint64_t, NPC_TYPES_COUNT>, NPC_TYPES_COUNT> _kills;
+
+    std::size_t _linesPerSecond;
+
+    std::chrono::steady_clock::time_point _windowStart;
+
+    std::size_t _windowLines;
+
+    std::uint64_t _suppressed;
 };
 
 #endif //MAI_OOP_2025_OBSERVER_H
\ No newline at end of file
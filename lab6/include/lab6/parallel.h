@@ -0,0 +1,54 @@
+#ifndef MAI_OOP_2025_PARALLEL_H
+#define MAI_OOP_2025_PARALLEL_H
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Number of worker threads to use by default, at least one.
+ */
+auto GetWorkersCount() -> std::size_t;
+
+/**
+ * Runs function(part) for every part in [0, count), each on its own thread.
+ * Part 0 runs on the calling thread. The first exception thrown by any part
+ * is rethrown once all of them have finished.
+ */
+template<typename Function>
+auto ParallelFor(std::size_t count,
+                 Function &&function) -> void {
+    std::vector<std::exception_ptr> errors(count);
+
+    auto run = [&function, &errors] (std::size_t part) -> void {
+        try {
+            function(part);
+        }
+        catch (...) {
+            errors[part] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t part = 1; part < count; ++part) {
+        threads.emplace_back(run, part);
+    }
+
+    if (count != 0) {
+        run(0);
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+#endif //MAI_OOP_2025_PARALLEL_H
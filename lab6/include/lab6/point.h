@@ -2,8 +2,17 @@
 #define MAI_OOP_2025_POINT_H
 
 #include <cstdint>
+#include <limits>
 
 
+/**
+ * Storage type of a single coordinate. Its largest value is reserved for
+ * inputs that do not fit, so they stay outside of every world.
+ */
+using Coordinate = std::uint16_t;
+
+constexpr std::uint64_t COORDINATE_LIMIT = std::numeric_limits<Coordinate>::max();
+
 class Point {
 public:
 
@@ -12,13 +21,13 @@ public:
 
 public:
 
-    auto GetX() const -> std::uint64_t;
+    auto GetX() const -> Coordinate;
 
-    auto GetY() const -> std::uint64_t;
+    auto GetY() const -> Coordinate;
 
 private:
 
-    std::uint64_t _x, _y;
+    Coordinate _x, _y;
 };
 
-#endif //MAI_OOP_2025_POINT_H
\ No newline at end of file
+#endif //MAI_OOP_2025_POINT_H
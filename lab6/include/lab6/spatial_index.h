@@ -0,0 +1,112 @@
+#ifndef MAI_OOP_2025_SPATIAL_INDEX_H
+#define MAI_OOP_2025_SPATIAL_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <lab6/world.h>
+
+
+/**
+ * Uniform grid over the world. Every cell keeps (index, point) entries
+ * of the objects inside it; entries inserted in increasing index order
+ * stay sorted by index within a cell.
+ */
+class SpatialIndex final {
+public:
+
+    static constexpr std::uint64_t DEFAULT_CELL_SIZE = 16;
+
+    static constexpr std::uint64_t MAX_CELLS = 1 << 20;
+
+public:
+
+    struct Entry {
+        std::uint32_t index;
+        Point point;
+    };
+
+public:
+
+    explicit SpatialIndex(const WorldBounds &bounds,
+                          std::uint64_t cellSize = DEFAULT_CELL_SIZE);
+
+public:
+
+    auto Insert(std::uint32_t index,
+                Point point) -> void;
+
+    auto Clear() -> void;
+
+    /**
+     * Drops all entries and regrids with the given cell size.
+     */
+    auto Reset(std::uint64_t cellSize) -> void;
+
+public:
+
+    /**
+     * Cell size the grid would get for the requested one, which is raised
+     * when needed to keep the grid within MAX_CELLS cells.
+     */
+    auto FitCellSize(std::uint64_t cellSize) const -> std::uint64_t;
+
+    auto GetCellSize() const -> std::uint64_t;
+
+    /**
+     * Row of cells a point falls into. Inserts into different rows touch
+     * different cells, so they may run on different threads.
+     */
+    auto GetRow(Point point) const -> std::uint64_t;
+
+    auto GetRowsCount() const -> std::uint64_t;
+
+public:
+
+    auto QueryKNearest(Point center,
+                       std::size_t count) const -> std::vector<std::uint32_t>;
+
+public:
+
+    template<typename Function>
+    auto ForEachInRect(Point min,
+                       Point max,
+                       Function &&function) const -> void {
+        std::uint64_t min_x = min.GetX(), min_y = min.GetY();
+        std::uint64_t max_x = std::min<std::uint64_t>(max.GetX(), _maxX);
+        std::uint64_t max_y = std::min<std::uint64_t>(max.GetY(), _maxY);
+
+        if (min_x > max_x || min_y > max_y) {
+            return;
+        }
+
+        for (auto cell_y = min_y / _cellSize; cell_y <= max_y / _cellSize; ++cell_y) {
+            for (auto cell_x = min_x / _cellSize; cell_x <= max_x / _cellSize; ++cell_x) {
+                for (const auto &entry : _cells[cell_y * _columns + cell_x]) {
+                    std::uint64_t x = entry.point.GetX(), y = entry.point.GetY();
+
+                    if (x >= min_x && x <= max_x && y >= min_y && y <= max_y) {
+                        function(entry);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+
+    auto GetCell(Point point) -> std::vector<Entry> &;
+
+private:
+
+    std::uint64_t _maxX, _maxY;
+
+    std::uint64_t _cellSize;
+
+    std::uint64_t _columns, _rows;
+
+    std::vector<std::vector<Entry>> _cells;
+};
+
+#endif //MAI_OOP_2025_SPATIAL_INDEX_H
@@ -0,0 +1,91 @@
+#ifndef MAI_OOP_2025_SUBSCRIPTION_INDEX_H
+#define MAI_OOP_2025_SUBSCRIPTION_INDEX_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <lab6/observer.h>
+#include <lab6/world.h>
+
+
+/**
+ * Observers indexed by the (killer type, victim type) pairs they subscribe
+ * to. Observers with a region are also bucketed by the cells of a coarse
+ * grid their region overlaps, so a kill is only checked against observers
+ * that can match it. Matching observers are reported in subscription order.
+ */
+class SubscriptionIndex final {
+public:
+
+    static constexpr std::uint64_t REGION_GRID_SIZE = 16;
+
+public:
+
+    explicit SubscriptionIndex(const WorldBounds &bounds);
+
+public:
+
+    auto Add(const ObserverPtr &observer,
+             const ObserverFilter &filter) -> void;
+
+public:
+
+    template<typename Function>
+    auto ForEachSubscriber(NPCType killer,
+                           NPCType victim,
+                           Point point,
+                           Function &&function) const -> void {
+        const auto &pair = _pairs[static_cast<std::size_t>(killer) * NPC_TYPES_COUNT + static_cast<std::size_t>(victim)];
+
+        const auto &everywhere = pair.everywhere;
+        const auto *regional   = pair.cells.empty() ? nullptr : &pair.cells[GetCell(point)];
+
+        std::size_t next = 0, next_regional = 0;
+        std::size_t regional_size = regional ? regional->size() : 0;
+
+        // Both lists are in subscription order, merging them keeps that order
+        while (next < everywhere.size() || next_regional < regional_size) {
+            if (next_regional == regional_size
+                || (next < everywhere.size() && everywhere[next] < (*regional)[next_regional])) {
+                function(*_subscribers[everywhere[next++]].observer);
+
+                continue;
+            }
+
+            const auto &subscriber = _subscribers[(*regional)[next_regional++]];
+
+            if (subscriber.region->Contains(point)) {
+                function(*subscriber.observer);
+            }
+        }
+    }
+
+private:
+
+    struct Subscriber {
+        ObserverPtr observer;
+        std::optional<KillRegion> region;
+    };
+
+    struct PairSubscribers {
+        // Subscriber numbers of observers without a region
+        std::vector<std::uint32_t> everywhere;
+        // Subscriber numbers of regional observers per grid cell, empty while there are none
+        std::vector<std::vector<std::uint32_t>> cells;
+    };
+
+private:
+
+    auto GetCell(Point point) const -> std::size_t;
+
+private:
+
+    std::uint64_t _cellWidth, _cellHeight;
+
+    std::vector<Subscriber> _subscribers;
+
+    std::array<PairSubscribers, NPC_TYPES_COUNT * NPC_TYPES_COUNT> _pairs;
+};
+
+#endif //MAI_OOP_2025_SUBSCRIPTION_INDEX_H
@@ -0,0 +1,105 @@
+#ifndef MAI_OOP_2025_TRACE_H
+#define MAI_OOP_2025_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+struct TraceEvent {
+    const char *name;
+    const char *category;
+    std::int64_t start;
+    std::int64_t duration;
+};
+
+/**
+ * Process-wide recorder of timed spans. Every thread appends to its own
+ * buffer without locking; the buffers are written as Chrome trace-event
+ * JSON, which opens in Perfetto and chrome://tracing.
+ */
+class Tracer final {
+public:
+
+    static auto Get() -> Tracer &;
+
+public:
+
+    auto Enable() -> void;
+
+    auto Disable() -> void;
+
+    auto IsEnabled() const -> bool;
+
+    /**
+     * Name and category are kept by pointer and must outlive the tracer
+     * (string literals). Times are in nanoseconds of Now().
+     */
+    auto Record(const char *name,
+                const char *category,
+                std::int64_t start,
+                std::int64_t end) -> void;
+
+    /**
+     * Write and Clear must not run while other threads are recording.
+     */
+    auto Write(std::ostream &ostream) const -> void;
+
+    auto WriteFile(const std::string &filename) const -> int32_t;
+
+    auto Clear() -> void;
+
+    static auto Now() -> std::int64_t;
+
+private:
+
+    struct ThreadBuffer {
+        std::uint32_t thread;
+        std::vector<TraceEvent> events;
+    };
+
+private:
+
+    Tracer();
+
+    auto GetThreadBuffer() -> ThreadBuffer &;
+
+private:
+
+    std::atomic<bool> _enabled;
+
+    // Guards registration of thread buffers only, never the recording itself
+    mutable std::mutex _mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> _buffers;
+};
+
+/**
+ * Records the time from its construction to its destruction as a span,
+ * if tracing was enabled when it was constructed.
+ */
+class TraceSpan final {
+public:
+
+    explicit TraceSpan(const char *name,
+                       const char *category = "game");
+
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan &) = delete;
+
+    auto operator=(const TraceSpan &) -> TraceSpan & = delete;
+
+private:
+
+    const char *_name;
+    const char *_category;
+
+    // Negative while tracing is disabled
+    std::int64_t _start;
+};
+
+#endif //MAI_OOP_2025_TRACE_H
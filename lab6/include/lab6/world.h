@@ -0,0 +1,34 @@
+#ifndef MAI_OOP_2025_WORLD_H
+#define MAI_OOP_2025_WORLD_H
+
+#include <lab6/point.h>
+
+
+constexpr Coordinate MAX_COORDINATE = 500;
+
+/**
+ * Inclusive world bounds [0, max x] x [0, max y]. The only place where
+ * coordinates are validated.
+ */
+class WorldBounds final {
+public:
+
+    explicit WorldBounds(std::uint64_t maxX = MAX_COORDINATE,
+                         std::uint64_t maxY = MAX_COORDINATE);
+
+public:
+
+    auto Contains(Point point) const -> bool;
+
+public:
+
+    auto GetMaxX() const -> Coordinate;
+
+    auto GetMaxY() const -> Coordinate;
+
+private:
+
+    Coordinate _maxX, _maxY;
+};
+
+#endif //MAI_OOP_2025_WORLD_H
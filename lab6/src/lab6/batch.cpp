@@ -0,0 +1,161 @@
+#include <chrono>
+#include <mutex>
+
+#include <lab6/batch.h>
+#include <lab6/parallel.h>
+#include <lab6/trace.h>
+
+
+auto GenerateUniformScenario(Game &game,
+                             const ScenarioParameters &parameters,
+                             std::mt19937_64 &random) -> void {
+    const auto &bounds = game.GetBounds();
+
+    for (std::size_t i = 0; i < parameters.npcs; ++i) {
+        auto type = static_cast<NPCType>(random() % NPC_TYPES_COUNT);
+        Point point(random() % (bounds.GetMaxX() + 1), random() % (bounds.GetMaxY() + 1));
+
+        game.AddNPC(type, point, "NPC_" + std::to_string(i));
+    }
+}
+
+auto SurvivalStats::GetSurvivalRate(NPCType type) const -> double {
+    auto index = static_cast<std::size_t>(type);
+
+    return spawned[index] != 0 ? static_cast<double>(survived[index]) / static_cast<double>(spawned[index]) : 0.0;
+}
+
+auto SurvivalStats::Merge(const SurvivalStats &other) -> void {
+    for (std::size_t type = 0; type < NPC_TYPES_COUNT; ++type) {
+        spawned[type]  += other.spawned[type];
+        survived[type] += other.survived[type];
+    }
+}
+
+auto BatchReport::GetGamesPerSecond() const -> double {
+    return seconds > 0.0 ? static_cast<double>(games) / seconds : 0.0;
+}
+
+BatchRunner::BatchRunner(ScenarioGenerator generator,
+                         std::size_t workers)
+        : _generator(std::move(generator)),
+          _workers(workers != 0 ? workers : GetWorkersCount()) {}
+
+auto BatchRunner::Run(const std::vector<ScenarioParameters> &grid,
+                      std::size_t gamesPerSet,
+                      std::uint64_t seed) const -> BatchReport {
+    auto start = std::chrono::steady_clock::now();
+
+    auto total   = grid.size() * gamesPerSet;
+    auto workers = std::max<std::size_t>(std::min(_workers, total), 1);
+
+    // Every worker owns a contiguous range of games and takes from its front;
+    // an idle worker steals the back half of another worker's range
+    struct WorkRange {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    std::vector<WorkRange> ranges(workers);
+
+    for (std::size_t worker = 0; worker < workers; ++worker) {
+        ranges[worker].begin = total * worker / workers;
+        ranges[worker].end   = total * (worker + 1) / workers;
+    }
+
+    auto take = [&ranges, workers] (std::size_t worker, std::size_t &task) -> bool {
+        {
+            std::lock_guard lock(ranges[worker].mutex);
+
+            if (ranges[worker].begin < ranges[worker].end) {
+                task = ranges[worker].begin++;
+
+                return true;
+            }
+        }
+
+        for (std::size_t offset = 1; offset < workers; ++offset) {
+            auto &victim = ranges[(worker + offset) % workers];
+
+            std::size_t begin, end;
+
+            {
+                std::lock_guard lock(victim.mutex);
+
+                if (victim.begin == victim.end) {
+                    continue;
+                }
+
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end   = victim.end;
+
+                victim.end = begin;
+            }
+
+            std::lock_guard lock(ranges[worker].mutex);
+
+            ranges[worker].begin = begin + 1;
+            ranges[worker].end   = end;
+
+            task = begin;
+
+            return true;
+        }
+
+        return false;
+    };
+
+    // Statistics per worker and parameter set, merged once all games are done
+    std::vector<std::vector<SurvivalStats>> stats(workers, std::vector<SurvivalStats>(grid.size()));
+
+    ParallelFor(workers, [this, &grid, &stats, &take, gamesPerSet, seed] (std::size_t worker) -> void {
+        TraceSpan span("BatchWorker", "batch");
+
+        auto factory = std::make_shared<NPCFactory>();
+
+        Game game(factory);
+        game.SetDumpStream(nullptr);
+
+        std::size_t task;
+
+        while (take(worker, task)) {
+            const auto &parameters = grid[task / gamesPerSet];
+            auto &set_stats        = stats[worker][task / gamesPerSet];
+
+            std::mt19937_64 random(seed + task);
+
+            // Clear also releases the names of the last game
+            game.Clear();
+
+            _generator(game, parameters, random);
+
+            for (std::size_t type = 0; type < NPC_TYPES_COUNT; ++type) {
+                set_stats.spawned[type] += game.CountNPCs(static_cast<NPCType>(type));
+            }
+
+            game.StartBattle(parameters.distance);
+
+            for (std::size_t type = 0; type < NPC_TYPES_COUNT; ++type) {
+                set_stats.survived[type] += game.CountNPCs(static_cast<NPCType>(type));
+            }
+        }
+    });
+
+    BatchReport report;
+    report.games = total;
+
+    for (std::size_t set = 0; set < grid.size(); ++set) {
+        BatchResult result { grid[set], gamesPerSet, SurvivalStats() };
+
+        for (const auto &worker_stats : stats) {
+            result.stats.Merge(worker_stats[set]);
+        }
+
+        report.results.push_back(result);
+    }
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return report;
+}
@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <lab6/battle_checkpoint.h>
+
+
+auto BattleCheckpoint::Save(std::ostream &ostream) const -> void {
+    ostream << "checkpoint " << static_cast<int>(metric) << " " << bound << " " << npcs << " " << world << "\n"
+            << "cursor " << defender << " " << notified << "\n"
+            << "kills " << kills.size() << "\n";
+
+    for (const auto &kill : kills) {
+        ostream << kill.attacker << " " << kill.defender << "\n";
+    }
+}
+
+auto BattleCheckpoint::SaveFile(const std::string &filename) const -> int32_t {
+    auto temporary = filename + ".tmp";
+
+    std::ofstream file(temporary);
+
+    if (!file.is_open()) {
+        return 1;
+    }
+
+    Save(file);
+
+    file.close();
+
+    if (!file || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::remove(temporary.c_str());
+
+        return 1;
+    }
+
+    return 0;
+}
+
+auto BattleCheckpoint::Load(std::istream &istream) -> BattleCheckpoint {
+    BattleCheckpoint checkpoint {};
+
+    std::string header, cursor, kills;
+    int metric;
+    std::size_t count;
+
+    if (!(istream >> header >> metric >> checkpoint.bound >> checkpoint.npcs >> checkpoint.world) || header != "checkpoint") {
+        throw std::runtime_error("[ERROR] Expected 'checkpoint <metric> <bound> <npcs> <world>' in battle checkpoint!");
+    }
+
+    if (metric < static_cast<int>(MetricKind::Euclidean) || metric > static_cast<int>(MetricKind::Chebyshev)) {
+        throw std::runtime_error("[ERROR] Unknown metric " + std::to_string(metric) + " in battle checkpoint!");
+    }
+
+    checkpoint.metric = static_cast<MetricKind>(metric);
+
+    if (!(istream >> cursor >> checkpoint.defender >> checkpoint.notified) || cursor != "cursor") {
+        throw std::runtime_error("[ERROR] Expected 'cursor <defender> <notified>' in battle checkpoint!");
+    }
+
+    if (!(istream >> kills >> count) || kills != "kills") {
+        throw std::runtime_error("[ERROR] Expected 'kills <count>' in battle checkpoint!");
+    }
+
+    // Every NPC is killed at most once, so a larger count means a corrupt file
+    if (count > checkpoint.npcs) {
+        throw std::runtime_error("[ERROR] Kill count " + std::to_string(count) + " exceeds "
+                                 + std::to_string(checkpoint.npcs) + " NPCs in battle checkpoint!");
+    }
+
+    // Read one by one, so a truncated file fails before its count is allocated
+    for (std::size_t index = 0; index < count; ++index) {
+        KillRecord kill {};
+
+        if (!(istream >> kill.attacker >> kill.defender)) {
+            throw std::runtime_error("[ERROR] Expected " + std::to_string(count) + " kills in battle checkpoint!");
+        }
+
+        checkpoint.kills.push_back(kill);
+    }
+
+    return checkpoint;
+}
+
+auto BattleCheckpoint::LoadFile(const std::string &filename) -> BattleCheckpoint {
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("[ERROR] Can't open battle checkpoint file '" + filename + "'!");
+    }
+
+    return Load(file);
+}
@@ -0,0 +1,85 @@
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <lab6/battle_rules.h>
+
+
+BattleRules::BattleRules()
+        : _victims {},
+          _attackers {} {
+    Set(NPCType::Squirrel, NPCType::Werewolf, true);
+    Set(NPCType::Squirrel, NPCType::Druid, true);
+    Set(NPCType::Werewolf, NPCType::Druid, true);
+}
+
+auto BattleRules::Load(std::istream &istream) -> BattleRules {
+    BattleRules rules;
+
+    std::string line;
+
+    for (std::size_t line_number = 1; std::getline(istream, line); ++line_number) {
+        std::istringstream string_stream(line);
+
+        std::string str_attacker, str_defender, str_verdict, rest;
+
+        if (!(string_stream >> str_attacker) || str_attacker.starts_with('#')) {
+            continue;
+        }
+
+        auto location = " in battle rules at line " + std::to_string(line_number) + "!";
+
+        if (!(string_stream >> str_defender >> str_verdict) || (string_stream >> rest)) {
+            throw std::runtime_error("[ERROR] Expected '<attacker> <defender> kills|spares'" + location);
+        }
+
+        auto parse_type = [&location] (const std::string &string) -> NPCType {
+            try {
+                return StringToNPCType(string);
+            }
+            catch (const std::runtime_error &) {
+                throw std::runtime_error("[ERROR] Unknown NPC type '" + string + "'" + location);
+            }
+        };
+
+        auto attacker = parse_type(str_attacker);
+        auto defender = parse_type(str_defender);
+
+        if (str_verdict != "kills" && str_verdict != "spares") {
+            throw std::runtime_error("[ERROR] Unknown verdict '" + str_verdict + "', expected 'kills' or 'spares'" + location);
+        }
+
+        rules.Set(attacker, defender, str_verdict == "kills");
+    }
+
+    return rules;
+}
+
+auto BattleRules::LoadFile(const std::string &filename) -> BattleRules {
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("[ERROR] Can't open battle rules file '" + filename + "'!");
+    }
+
+    return Load(file);
+}
+
+auto BattleRules::Set(NPCType attacker,
+                      NPCType defender,
+                      bool kills) -> void {
+    auto attacker_bit = 1U << static_cast<std::size_t>(attacker);
+    auto defender_bit = 1U << static_cast<std::size_t>(defender);
+
+    auto &victims   = _victims[static_cast<std::size_t>(attacker)];
+    auto &attackers = _attackers[static_cast<std::size_t>(defender)];
+
+    if (kills) {
+        victims   |= defender_bit;
+        attackers |= attacker_bit;
+    }
+    else {
+        victims   &= ~defender_bit;
+        attackers &= ~attacker_bit;
+    }
+}
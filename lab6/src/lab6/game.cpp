@@ -1,47 +1,299 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <iterator>
 
 #include <lab6/game.h>
-#include <lab6/visitor.h>
-
+#include <lab6/parallel.h>
+#include <lab6/trace.h>
+
+
+Game::Game(NPCFactoryPtr factory,
+           BattleRules rules)
+        : _indices(NPC_TYPES_COUNT, SpatialIndex(factory->GetBounds())),
+          _npcFactory(std::move(factory)),
+          _subscriptions(_npcFactory->GetBounds()),
+          _rules(rules),
+          _dumpStream(&std::cout),
+          _checkpointInterval(0),
+          _generation(0),
+          _stableGeneration(UINT64_MAX),
+          _stableMetric(MetricKind::Euclidean),
+          _stableBound(0),
+          _stableCount(0) {}
+
+Game::~Game() {
+    for (const auto &npc : _npcs) {
+        _npcFactory->ReleaseName(npc->GetNameId());
+    }
+}
 
-Game::Game(NPCFactoryPtr factory)
-        : _npcFactory(std::move(factory)) {}
+auto Game::StartBattle(double distance) -> int32_t {
+    return StartBattle<EuclideanMetric>(distance);
+}
 
+template<typename Metric>
 auto Game::StartBattle(double distance) -> int32_t {
-    DumpObjects(std::cout);
+    TraceSpan battle_span("StartBattle", "battle");
+
+    auto bound = RangeBound<Metric>(distance);
+
+    // Survivors of a battle never kill each other at that or any smaller distance
+    auto same_metric   = _stableMetric == Metric::KIND;
+    auto within_stable = same_metric && bound <= _stableBound;
+
+    if (within_stable && _stableGeneration == _generation) {
+        return 0;
+    }
+
+    if (_dumpStream) {
+        DumpObjects(*_dumpStream);
+    }
+
+    // The first _stableCount NPCs are known not to kill each other below _stableBound,
+    // so a pair of them is only examined when it is farther apart than that
+    auto known = same_metric ? _stableCount : 0;
+
+    BattleCheckpoint state { Metric::KIND,
+                             bound,
+                             _npcs.size(),
+                             _checkpointInterval != 0 ? GetFingerprint() : 0,
+                             0,
+                             0,
+                             {} };
+
+    return RunBattle<Metric>(state, known, within_stable);
+}
+
+template auto Game::StartBattle<EuclideanMetric>(double distance) -> int32_t;
+template auto Game::StartBattle<ManhattanMetric>(double distance) -> int32_t;
+template auto Game::StartBattle<ChebyshevMetric>(double distance) -> int32_t;
+
+auto Game::SetCheckpointHandler(CheckpointHandler handler,
+                                std::size_t interval) -> void {
+    _checkpointHandler  = std::move(handler);
+    _checkpointInterval = _checkpointHandler ? interval : 0;
+}
+
+auto Game::ResumeBattle(const BattleCheckpoint &checkpoint) -> int32_t {
+    TraceSpan battle_span("ResumeBattle", "battle");
+
+    if (checkpoint.npcs != _npcs.size() || checkpoint.world != GetFingerprint()) {
+        return 1;
+    }
+
+    if (checkpoint.defender > _npcs.size() || checkpoint.notified > checkpoint.kills.size()) {
+        return 1;
+    }
+
+    for (const auto &kill : checkpoint.kills) {
+        if (kill.attacker >= _npcs.size() || kill.defender >= checkpoint.defender) {
+            return 1;
+        }
+    }
+
+    // Pairs skipped by an incremental battle are known not to kill, so
+    // evaluating the rest without them finds the same kills
+    auto state = checkpoint;
+
+    switch (checkpoint.metric) {
+        case MetricKind::Euclidean:
+            return RunBattle<EuclideanMetric>(state, 0, false);
+        case MetricKind::Manhattan:
+            return RunBattle<ManhattanMetric>(state, 0, false);
+        case MetricKind::Chebyshev:
+            return RunBattle<ChebyshevMetric>(state, 0, false);
+    }
+
+    return 1;
+}
+
+template<typename Metric>
+auto Game::RunBattle(BattleCheckpoint &state,
+                     std::size_t known,
+                     bool withinStable) -> int32_t {
+    auto bound = state.bound;
+
+    // Within the stable bound an old defender can only fall to a new attacker,
+    // so only old defenders in reach of a new NPC have to be looked at
+    auto reach = bound != 0 ? Metric::Reach(bound - 1) : 0;
+
+    // Cells of reach + 1 keep every search box, 2 * reach + 1 wide, within 3x3 cells of a grid
+    if (auto cell_size = _indices.front().FitCellSize(reach + 1);
+        bound != 0 && cell_size != _indices.front().GetCellSize()) {
+        RebuildIndex(cell_size);
+    }
+
+    EvaluatePairs<Metric>(state, reach, known, withinStable);
+
+    {
+        TraceSpan resolution_span("KillResolution", "battle");
 
-    Battle battle(*this);
+        for (std::size_t kill = 0; kill < state.kills.size(); ++kill) {
+            auto [attacker, defender] = state.kills[kill];
 
-    for (auto &defender : _npcs) {
-        battle.SetTarget(defender);
+            _npcs[defender]->Kill();
 
-        for (auto &attacker : _npcs) {
-            if (!attacker->CanAttack(*defender, distance)) {
+            if (kill < state.notified) {
                 continue;
             }
 
-            attacker->Accept(&battle);
+            NotifyKill(*_npcs[attacker], *_npcs[defender]);
 
-            if (defender->GetKilled()) {
-                break;
+            state.notified = kill + 1;
+
+            if (_checkpointInterval != 0 && state.notified % _checkpointInterval == 0) {
+                _checkpointHandler(state);
             }
         }
     }
 
-    std::erase_if(_npcs, [] (const NPCPtr &npc) -> bool {
-        return npc->GetKilled();
-    });
+    {
+        TraceSpan compaction_span("Compaction", "battle");
+
+        auto killed = std::erase_if(_npcs, [this] (const NPCPtr &npc) -> bool {
+            if (!npc->GetKilled()) {
+                return false;
+            }
+
+            _names[npc->GetNameId()] = false;
 
-    DumpObjects(std::cout);
+            _npcFactory->ReleaseName(npc->GetNameId());
+
+            return true;
+        });
+
+        if (killed != 0) {
+            ++_generation;
+
+            RebuildIndex(_indices.front().GetCellSize());
+        }
+    }
+
+    NotifyBattleEnd();
+
+    _stableGeneration = _generation;
+    _stableMetric     = Metric::KIND;
+    _stableBound      = bound;
+    _stableCount      = _npcs.size();
+
+    if (_dumpStream) {
+        DumpObjects(*_dumpStream);
+    }
 
     return 0;
 }
 
+template<typename Metric>
+auto Game::EvaluatePairs(BattleCheckpoint &state,
+                         std::uint64_t reach,
+                         std::size_t known,
+                         bool withinStable) const -> void {
+    TraceSpan evaluation_span("PairEvaluation", "battle");
+
+    auto bound = state.bound;
+
+    std::vector<bool> exposed;
+
+    if (withinStable) {
+        exposed.resize(known);
+
+        for (auto index = known; index < _npcs.size(); ++index) {
+            auto [min, max] = ReachRect(_npcs[index]->GetPoint(), reach);
+            auto attacker   = _npcs[index]->GetType();
+
+            for (std::size_t defender = 0; defender < NPC_TYPES_COUNT; ++defender) {
+                if (!_rules.CanKill(attacker, static_cast<NPCType>(defender))) {
+                    continue;
+                }
+
+                _indices[defender].ForEachInRect(min, max, [&exposed, known] (const SpatialIndex::Entry &entry) -> void {
+                    if (entry.index < known) {
+                        exposed[entry.index] = true;
+                    }
+                });
+            }
+        }
+    }
+
+    // Kill state is mirrored densely so candidate attackers are checked without touching the NPCs.
+    // NPCs killed by a battle interrupted before compaction are still in the world and stay dead
+    std::vector<std::uint8_t> dead(_npcs.size(), 0);
+
+    for (std::size_t index = 0; index < _npcs.size(); ++index) {
+        dead[index] = _npcs[index]->GetKilled();
+    }
+
+    for (const auto &kill : state.kills) {
+        dead[kill.defender] = 1;
+    }
+
+    auto first_defender = state.defender;
+
+    while (bound != 0 && state.defender < _npcs.size()) {
+        if (_checkpointInterval != 0 && state.defender != first_defender && state.defender % _checkpointInterval == 0) {
+            _checkpointHandler(state);
+        }
+
+        auto defender_index = state.defender++;
+        auto old_defender = defender_index < known;
+
+        if (dead[defender_index] || (old_defender && withinStable && !exposed[defender_index])) {
+            continue;
+        }
+
+        auto &defender = _npcs[defender_index];
+        auto point     = defender->GetPoint();
+
+        auto [min, max] = ReachRect(point, reach);
+
+        // Only buckets whose type kills the defender's type are searched, and the
+        // first such attacker in world order is the one that strikes
+        auto first_attacker = UINT32_MAX;
+
+        auto attacker_types = _rules.GetAttackers(defender->GetType());
+
+        for (std::size_t attacker_type = 0; attacker_type < NPC_TYPES_COUNT; ++attacker_type) {
+            if (!((attacker_types >> attacker_type) & 1U)) {
+                continue;
+            }
+
+            _indices[attacker_type].ForEachInRect(min, max, [&] (const SpatialIndex::Entry &entry) -> void {
+                if (entry.index >= first_attacker || entry.index == defender_index) {
+                    return;
+                }
+
+                auto measure = Metric::Distance(point, entry.point);
+
+                if (measure >= bound) {
+                    return;
+                }
+
+                if (old_defender && entry.index < known && measure < _stableBound) {
+                    return;
+                }
+
+                if (dead[entry.index]) {
+                    return;
+                }
+
+                first_attacker = entry.index;
+            });
+        }
+
+        if (first_attacker != UINT32_MAX) {
+            dead[defender_index] = 1;
+
+            state.kills.push_back(KillRecord { first_attacker, static_cast<std::uint32_t>(defender_index) });
+        }
+    }
+}
+
 auto Game::AddNPC(NPCType type,
                   Point point,
-                  const std::string &name) -> int32_t {
+                  std::string_view name) -> int32_t {
     auto npc = _npcFactory->CreateNPC(type,
                                              point,
                                              name);
@@ -53,74 +305,554 @@ auto Game::AddNPC(NPCType type,
     return AppendNPC(npc);
 }
 
-auto Game::SaveObjects(const std::string &filename) const -> int32_t {
+auto Game::SaveObjects(const std::string &filename,
+                       std::size_t workers) const -> int32_t {
+    TraceSpan span("SaveObjects", "io");
+
     std::ofstream file(filename);
 
     if (!file.is_open()) {
         return 1;
     }
 
-    DumpObjects(file);
+    DumpObjects(file, workers);
 
     file.close();
 
     return 0;
 }
 
-auto Game::LoadObjects(const std::string &filename) -> int32_t {
+auto Game::SaveObjectsAsync(const std::string &filename) const -> std::future<int32_t> {
+    // Names are copied, as released names of the factory's table may be overwritten
+    struct SnapshotRecord {
+        NPCType type;
+        Point point;
+        FixedName name;
+    };
+
+    std::vector<SnapshotRecord> snapshot;
+    snapshot.reserve(_npcs.size());
+
+    for (const auto &npc : _npcs) {
+        snapshot.push_back(SnapshotRecord { npc->GetType(), npc->GetPoint(), FixedName(GetName(*npc)) });
+    }
+
+    return std::async(std::launch::async, [snapshot = std::move(snapshot), filename] () -> int32_t {
+        TraceSpan span("SaveObjectsAsync", "io");
+
+        std::ofstream file(filename);
+
+        if (!file.is_open()) {
+            return 1;
+        }
+
+        WriteRecords(file, snapshot.size(), 0, [&snapshot] (std::size_t index) -> NPCRecord {
+            const auto &record = snapshot[index];
+
+            return NPCRecord { record.type, record.point, record.name.GetView() };
+        });
+
+        file.close();
+
+        return 0;
+    });
+}
+
+auto Game::LoadObjects(const std::string &filename,
+                       std::size_t workers) -> int32_t {
+    TraceSpan span("LoadObjects", "io");
+
     std::ifstream file(filename);
 
     if (!file.is_open()) {
         return 1;
     }
 
-    while (auto npc = _npcFactory->LoadNPC(file)) {
-        if (AppendNPC(npc)) {
-            break;
-        }
+    std::string content;
+
+    file.seekg(0, std::ios::end);
+
+    if (auto size = file.tellg(); size > 0) {
+        content.resize(static_cast<std::size_t>(size));
+        file.seekg(0, std::ios::beg);
+        file.read(content.data(), size);
+        content.resize(static_cast<std::size_t>(file.gcount()));
     }
 
     file.close();
 
-    return 0;
+    // Only complete lines are loaded, a trailing line without '\n' is ignored
+    std::string_view text(content);
+    text = text.substr(0, text.rfind('\n') + 1);
+
+    if (workers == 0) {
+        workers = std::min(GetWorkersCount(), text.size() / LOAD_CHUNK_SIZE + 1);
+    }
+
+    // Newline-aligned chunks, parsed on worker threads into local batches
+    std::vector<std::string_view> chunks;
+
+    while (!text.empty()) {
+        auto size = std::max<std::size_t>(text.size() / (workers - chunks.size()), 1);
+        auto end  = workers - chunks.size() == 1 ? text.size() : text.find('\n', size - 1) + 1;
+
+        chunks.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+
+    struct LoadedChunk {
+        std::vector<NPCRecord> records;
+
+        // Parse error, out-of-bounds point or too long name right after the records, if any
+        std::exception_ptr error;
+        bool stopped = false;
+        bool rejected = false;
+
+        // Position of the first record among the records of all chunks
+        std::size_t offset = 0;
+    };
+
+    std::vector<LoadedChunk> loaded(chunks.size());
+
+    ParallelFor(chunks.size(), [this, &chunks, &loaded] (std::size_t part) -> void {
+        TraceSpan chunk_span("ParseChunk", "io");
+
+        auto chunk  = chunks[part];
+        auto &batch = loaded[part];
+
+        while (!chunk.empty()) {
+            auto end = chunk.find('\n');
+
+            try {
+                auto record = _npcFactory->ParseNPC(chunk.substr(0, end));
+
+                if (!_npcFactory->GetBounds().Contains(record.point)) {
+                    batch.stopped = true;
+
+                    break;
+                }
+
+                if (!_npcFactory->GetNames().Accepts(record.name)) {
+                    batch.stopped  = true;
+                    batch.rejected = true;
+
+                    break;
+                }
+
+                batch.records.push_back(record);
+            }
+            catch (...) {
+                batch.error = std::current_exception();
+
+                break;
+            }
+
+            chunk.remove_prefix(end + 1);
+        }
+    });
+
+    // Records up to the first chunk that stopped early are candidates,
+    // the outcome of that chunk is the outcome of the load
+    std::size_t parsed = 0;
+
+    std::exception_ptr error;
+    int32_t result = 0;
+    auto finished  = false;
+
+    for (auto &batch : loaded) {
+        batch.offset = parsed;
+
+        if (finished) {
+            continue;
+        }
+
+        parsed += batch.records.size();
+
+        if (batch.error || batch.stopped) {
+            error    = batch.error;
+            result   = batch.rejected ? 1 : 0;
+            finished = true;
+        }
+    }
+
+    std::vector<std::string_view> names(parsed);
+    std::vector<std::size_t> hashes(parsed);
+    std::vector<NameId> ids;
+
+    ParallelFor(loaded.size(), [&loaded, &names, &hashes, parsed] (std::size_t part) -> void {
+        const auto &batch = loaded[part];
+
+        for (std::size_t record = 0; record < batch.records.size() && batch.offset + record < parsed; ++record) {
+            names[batch.offset + record]  = batch.records[record].name;
+            hashes[batch.offset + record] = NameTable::Hash(batch.records[record].name);
+        }
+    });
+
+    _npcFactory->InternNames(names, hashes, ids, loaded.size());
+
+    auto first = _npcs.size();
+    auto count = std::size_t(0);
+
+    {
+        TraceSpan names_span("TakeNames", "io");
+
+        // Only the check of names in file order runs on one thread, so the first
+        // occurrence of a name wins as in a sequential load
+        while (count < parsed && TakeName(ids[count])) {
+            ++count;
+        }
+
+        if (count < parsed) {
+            result = 0;
+            error  = nullptr;
+
+            for (auto index = count + 1; index < parsed; ++index) {
+                _npcFactory->ReleaseName(ids[index]);
+            }
+        }
+    }
+
+    _npcs.resize(first + count);
+
+    // NPCs of every chunk are created by its worker, and every worker fills
+    // the index cells of its band of rows, so cells get entries in world order
+    ParallelFor(loaded.size(), [this, &loaded, &ids, first, count] (std::size_t part) -> void {
+        TraceSpan chunk_span("CreateNPCs", "io");
+
+        const auto &batch = loaded[part];
+
+        for (std::size_t record = 0; record < batch.records.size() && batch.offset + record < count; ++record) {
+            const auto &parsed = batch.records[record];
+
+            _npcs[first + batch.offset + record] = _npcFactory->CreateNPC(parsed.type, parsed.point, ids[batch.offset + record]);
+        }
+    });
+
+    ParallelFor(loaded.size(), [this, &loaded, first, count] (std::size_t band) -> void {
+        TraceSpan band_span("IndexNPCs", "io");
+
+        for (const auto &batch : loaded) {
+            for (std::size_t record = 0; record < batch.records.size() && batch.offset + record < count; ++record) {
+                const auto &parsed = batch.records[record];
+                auto &index        = _indices[static_cast<std::size_t>(parsed.type)];
+
+                if (index.GetRow(parsed.point) * loaded.size() / index.GetRowsCount() == band) {
+                    index.Insert(static_cast<std::uint32_t>(first + batch.offset + record), parsed.point);
+                }
+            }
+        }
+    });
+
+    if (count != 0) {
+        ++_generation;
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return result;
+}
+
+auto Game::DumpObjects(std::ostream &ostream,
+                       std::size_t workers) const -> void {
+    TraceSpan span("DumpObjects", "io");
+
+    WriteRecords(ostream, _npcs.size(), workers, [this] (std::size_t index) -> NPCRecord {
+        const auto &npc = _npcs[index];
+
+        return NPCRecord { npc->GetType(), npc->GetPoint(), GetName(*npc) };
+    });
+}
+
+auto Game::SetDumpStream(std::ostream *ostream) -> void {
+    _dumpStream = ostream;
 }
 
-auto Game::DumpObjects(std::ostream &ostream) const -> void {
+auto Game::Clear() -> void {
     for (const auto &npc : _npcs) {
-        std::ostringstream string_stream;
+        _names[npc->GetNameId()] = false;
 
-        auto type = npc->GetType();
-        const auto &name = npc->GetName();
-        auto point = npc->GetPoint();
+        _npcFactory->ReleaseName(npc->GetNameId());
+    }
 
-        string_stream << "[" << NPCTypeToString(type) << "] "
-                      << name << " [" << point.GetX() << "," << point.GetY() << "]" << std::endl;
+    _npcs.clear();
 
-        ostream << string_stream.str();
+    for (auto &index : _indices) {
+        index.Clear();
     }
+
+    ++_generation;
+
+    _stableGeneration = UINT64_MAX;
+    _stableCount      = 0;
 }
 
-auto Game::AddObserver(const ObserverPtr &observer) -> void {
+auto Game::CountNPCs(NPCType type) const -> std::size_t {
+    return static_cast<std::size_t>(std::ranges::count_if(_npcs, [type] (const NPCPtr &npc) -> bool {
+        return npc->GetType() == type;
+    }));
+}
+
+auto Game::GetGeneration() const -> std::uint64_t {
+    return _generation;
+}
+
+auto Game::AddObserver(const ObserverPtr &observer,
+                       const ObserverFilter &filter) -> void {
     _observers.emplace_back(observer);
+
+    _subscriptions.Add(observer, filter);
+}
+
+auto Game::GetRules() const -> const BattleRules & {
+    return _rules;
+}
+
+auto Game::GetName(const NPC &npc) const -> std::string_view {
+    return _npcFactory->GetNames().GetName(npc.GetNameId());
+}
+
+auto Game::GetBounds() const -> const WorldBounds & {
+    return _npcFactory->GetBounds();
+}
+
+auto Game::QueryRect(Point min,
+                     Point max) const -> std::vector<const NPC *> {
+    std::vector<std::uint32_t> indices;
+
+    for (const auto &index : _indices) {
+        index.ForEachInRect(min, max, [&indices] (const SpatialIndex::Entry &entry) -> void {
+            indices.push_back(entry.index);
+        });
+    }
+
+    return ToNPCs(std::move(indices));
+}
+
+auto Game::QueryRadius(Point center,
+                       double radius) const -> std::vector<const NPC *> {
+    if (!(radius >= 0.0)) {
+        return {};
+    }
+
+    auto reach = static_cast<std::uint64_t>(std::min(std::ceil(radius), static_cast<double>(COORDINATE_LIMIT)));
+    auto limit = radius * radius;
+
+    auto [min, max] = ReachRect(center, reach);
+
+    std::vector<std::uint32_t> indices;
+
+    for (const auto &index : _indices) {
+        index.ForEachInRect(min, max, [&indices, center, limit] (const SpatialIndex::Entry &entry) -> void {
+            if (static_cast<double>(EuclideanMetric::Distance(center, entry.point)) <= limit) {
+                indices.push_back(entry.index);
+            }
+        });
+    }
+
+    return ToNPCs(std::move(indices));
+}
+
+auto Game::QueryKNearest(Point center,
+                         std::size_t count) const -> std::vector<const NPC *> {
+    // The k nearest overall are among the k nearest of every type bucket
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> candidates;
+
+    for (const auto &index : _indices) {
+        for (auto npc_index : index.QueryKNearest(center, count)) {
+            candidates.emplace_back(EuclideanMetric::Distance(center, _npcs[npc_index]->GetPoint()),
+                                    npc_index);
+        }
+    }
+
+    std::ranges::sort(candidates);
+
+    candidates.resize(std::min(candidates.size(), count));
+
+    std::vector<const NPC *> npcs;
+    npcs.reserve(candidates.size());
+
+    for (auto [distance, npc_index] : candidates) {
+        npcs.push_back(_npcs[npc_index].get());
+    }
+
+    return npcs;
 }
 
 auto Game::NotifyKill(const NPC &killer,
                       const NPC &killed) -> void {
+    TraceSpan span("NotifyKill", "observer");
+
+    // Only observers subscribed to this kill are reached
+    _subscriptions.ForEachSubscriber(killer.GetType(),
+                                     killed.GetType(),
+                                     killed.GetPoint(),
+                                     [this, &killer, &killed] (Observer &observer) -> void {
+        observer.OnKill(killer,
+                        killed,
+                        _npcFactory->GetNames());
+    });
+}
+
+auto Game::NotifyBattleEnd() -> void {
+    TraceSpan span("NotifyBattleEnd", "observer");
+
     for (auto &observer : _observers) {
-        observer->OnKill(killer,
-                         killed);
+        observer->OnBattleEnd();
     }
 }
 
+auto Game::GetFingerprint() const -> std::uint64_t {
+    // FNV-1a over the NPCs in world order and the rules matrix
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    auto mix = [&hash] (std::uint64_t value) -> void {
+        hash = (hash ^ value) * 1099511628211ULL;
+    };
+
+    for (const auto &npc : _npcs) {
+        mix(static_cast<std::uint64_t>(npc->GetType()));
+        mix(npc->GetPoint().GetX());
+        mix(npc->GetPoint().GetY());
+
+        for (auto character : GetName(*npc)) {
+            mix(static_cast<unsigned char>(character));
+        }
+
+        mix(UINT64_MAX);
+    }
+
+    for (std::size_t defender = 0; defender < NPC_TYPES_COUNT; ++defender) {
+        mix(_rules.GetAttackers(static_cast<NPCType>(defender)));
+    }
+
+    return hash;
+}
+
 auto Game::AppendNPC(const NPCPtr &npc) -> int32_t {
-    if (std::ranges::find_if(_npcs,
-                             [npc](const NPCPtr &tmp) -> bool {
-                                 return tmp->GetName() == npc->GetName();
-                             }) != _npcs.end()) {
+    if (!TakeName(npc->GetNameId())) {
         return 1;
     }
 
+    _indices[static_cast<std::size_t>(npc->GetType())].Insert(static_cast<std::uint32_t>(_npcs.size()),
+                                                              npc->GetPoint());
+
     _npcs.emplace_back(npc);
 
+    ++_generation;
+
     return 0;
 }
+
+auto Game::TakeName(NameId name) -> bool {
+    // The reference taken to the name is the game's from here on
+    if (name < _names.size() && _names[name]) {
+        _npcFactory->ReleaseName(name);
+
+        return false;
+    }
+
+    if (name >= _names.size()) {
+        _names.resize(name + 1);
+    }
+
+    _names[name] = true;
+
+    return true;
+}
+
+auto Game::RebuildIndex(std::uint64_t cellSize) -> void {
+    TraceSpan span("RebuildIndex", "battle");
+
+    for (auto &index : _indices) {
+        index.Reset(cellSize);
+    }
+
+    for (std::size_t index = 0; index < _npcs.size(); ++index) {
+        _indices[static_cast<std::size_t>(_npcs[index]->GetType())].Insert(static_cast<std::uint32_t>(index),
+                                                                            _npcs[index]->GetPoint());
+    }
+}
+
+auto Game::ReachRect(Point center,
+                     std::uint64_t reach) -> std::pair<Point, Point> {
+    Point min(center.GetX() > reach ? center.GetX() - reach : 0,
+              center.GetY() > reach ? center.GetY() - reach : 0);
+    Point max(center.GetX() + reach,
+              center.GetY() + reach);
+
+    return { min, max };
+}
+
+auto Game::FormatRecord(const NPCRecord &record,
+                        std::string &buffer) -> void {
+    char number[8];
+
+    auto append_number = [&buffer, &number] (Coordinate coordinate) -> void {
+        auto result = std::to_chars(std::begin(number), std::end(number), coordinate);
+
+        buffer.append(number, result.ptr);
+    };
+
+    buffer += '[';
+    buffer += NPCTypeToString(record.type);
+    buffer += "] ";
+    buffer += record.name;
+    buffer += " [";
+    append_number(record.point.GetX());
+    buffer += ',';
+    append_number(record.point.GetY());
+    buffer += "]\n";
+}
+
+template<typename Source>
+auto Game::WriteRecords(std::ostream &ostream,
+                        std::size_t count,
+                        std::size_t workers,
+                        Source &&source) -> void {
+    if (workers == 0) {
+        workers = std::min(GetWorkersCount(), count / SAVE_CHUNK_SIZE + 1);
+    }
+
+    // Rounds of at most SAVE_CHUNK_SIZE records per worker keep the buffers bounded.
+    // Within a round contiguous ranges are formatted into separate buffers and written in order
+    std::vector<std::string> buffers(std::max<std::size_t>(std::min(workers, count), 1));
+
+    auto round_size = buffers.size() * SAVE_CHUNK_SIZE;
+
+    for (std::size_t round_begin = 0; round_begin < count; round_begin += round_size) {
+        auto round_count = std::min(round_size, count - round_begin);
+
+        ParallelFor(buffers.size(), [&buffers, &source, round_begin, round_count] (std::size_t part) -> void {
+            TraceSpan span("FormatRecords", "io");
+
+            auto begin = round_begin + round_count * part / buffers.size();
+            auto end   = round_begin + round_count * (part + 1) / buffers.size();
+
+            buffers[part].clear();
+
+            for (auto index = begin; index < end; ++index) {
+                FormatRecord(source(index), buffers[part]);
+            }
+        });
+
+        for (const auto &buffer : buffers) {
+            ostream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+    }
+}
+
+auto Game::ToNPCs(std::vector<std::uint32_t> indices) const -> std::vector<const NPC *> {
+    // Cells are visited in grid order, results are reported in world order
+    std::ranges::sort(indices);
+
+    std::vector<const NPC *> npcs;
+    npcs.reserve(indices.size());
+
+    for (auto index : indices) {
+        npcs.push_back(_npcs[index].get());
+    }
+
+    return npcs;
+}
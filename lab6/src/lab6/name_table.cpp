@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include <lab6/name_table.h>
+#include <lab6/parallel.h>
+
+
+FixedName::FixedName()
+        : _data {},
+          _size(0) {}
+
+FixedName::FixedName(std::string_view name)
+        : _data {},
+          _size(static_cast<std::uint8_t>(name.size())) {
+    if (name.size() > MAX_NAME_LENGTH) {
+        throw std::runtime_error("[ERROR] Name '" + std::string(name) + "' is longer than "
+                                 + std::to_string(MAX_NAME_LENGTH) + " characters!");
+    }
+
+    name.copy(_data.data(), name.size());
+}
+
+auto FixedName::GetView() const -> std::string_view {
+    return { _data.data(), _size };
+}
+
+NameTable::NameTable(std::size_t maxLength)
+        : _maxLength(maxLength),
+          _size(0),
+          _ids(0) {
+    if (maxLength > MAX_NAME_LENGTH) {
+        throw std::runtime_error("[ERROR] Max name length " + std::to_string(maxLength) + " exceeds "
+                                 + std::to_string(MAX_NAME_LENGTH) + "!");
+    }
+}
+
+auto NameTable::Intern(std::string_view name) -> NameId {
+    CheckAccepts(name);
+
+    auto hash   = Hash(name);
+    auto &shard = _shards[GetShard(hash)];
+
+    Reserve(shard, 1);
+
+    auto slot = FindSlot(shard, name, hash);
+
+    if (shard.slots[slot] != EMPTY_SLOT) {
+        ++_references[shard.slots[slot]];
+
+        return shard.slots[slot];
+    }
+
+    PrepareIds(1);
+
+    NameId id;
+
+    // Released ids are reused first, so ids stay below the number of names ever alive at once
+    if (!_freeIds.empty()) {
+        id = _freeIds.back();
+
+        _freeIds.pop_back();
+    }
+    else {
+        id = static_cast<NameId>(_ids++);
+    }
+
+    Store(id, name);
+
+    shard.slots[slot] = id;
+
+    ++shard.size;
+    ++_size;
+
+    return id;
+}
+
+auto NameTable::InternAll(const std::vector<std::string_view> &names,
+                          const std::vector<std::size_t> &hashes,
+                          std::vector<NameId> &ids,
+                          std::size_t workers) -> void {
+    for (auto name : names) {
+        CheckAccepts(name);
+    }
+
+    std::array<std::size_t, SHARDS> counts {};
+
+    for (auto hash : hashes) {
+        ++counts[GetShard(hash)];
+    }
+
+    for (std::size_t shard = 0; shard < SHARDS; ++shard) {
+        Reserve(_shards[shard], counts[shard]);
+    }
+
+    PrepareIds(names.size());
+
+    ids.resize(names.size());
+
+    // New names take the free ids from the back, then fresh ones
+    std::atomic<std::size_t> taken = 0;
+
+    auto take_id = [this, &taken] () -> NameId {
+        auto index = taken.fetch_add(1, std::memory_order_relaxed);
+
+        return index < _freeIds.size() ? _freeIds[_freeIds.size() - 1 - index]
+                                       : static_cast<NameId>(_ids + (index - _freeIds.size()));
+    };
+
+    workers = std::clamp<std::size_t>(workers, 1, SHARDS);
+
+    // Shards, the names stored for new ids and their references are touched by one thread only
+    ParallelFor(workers, [this, &names, &hashes, &ids, &take_id, workers] (std::size_t part) -> void {
+        for (std::size_t index = 0; index < names.size(); ++index) {
+            auto shard_index = GetShard(hashes[index]);
+
+            if (shard_index % workers != part) {
+                continue;
+            }
+
+            auto &shard = _shards[shard_index];
+            auto slot   = FindSlot(shard, names[index], hashes[index]);
+
+            if (shard.slots[slot] != EMPTY_SLOT) {
+                ++_references[shard.slots[slot]];
+            }
+            else {
+                shard.slots[slot] = take_id();
+
+                Store(shard.slots[slot], names[index]);
+
+                ++shard.size;
+            }
+
+            ids[index] = shard.slots[slot];
+        }
+    });
+
+    auto added = taken.load();
+
+    if (added <= _freeIds.size()) {
+        _freeIds.resize(_freeIds.size() - added);
+    }
+    else {
+        _ids += added - _freeIds.size();
+
+        _freeIds.clear();
+    }
+
+    _size += added;
+}
+
+auto NameTable::Release(NameId id) -> void {
+    if (--_references[id] != 0) {
+        return;
+    }
+
+    auto hash   = Hash(GetName(id));
+    auto &shard = _shards[GetShard(hash)];
+    auto mask   = shard.slots.size() - 1;
+    auto hole   = GetHomeSlot(shard, hash);
+
+    while (shard.slots[hole] != id) {
+        hole = (hole + 1) & mask;
+    }
+
+    // Backward shift deletion: later entries of the probe run move into the hole
+    // unless that would put them before their home slot
+    for (auto slot = (hole + 1) & mask; shard.slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask) {
+        auto home = GetHomeSlot(shard, Hash(GetName(shard.slots[slot])));
+
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            shard.slots[hole] = shard.slots[slot];
+
+            hole = slot;
+        }
+    }
+
+    shard.slots[hole] = EMPTY_SLOT;
+
+    --shard.size;
+    --_size;
+
+    _freeIds.push_back(id);
+}
+
+auto NameTable::Clear() -> void {
+    _size = 0;
+    _ids  = 0;
+
+    _freeIds.clear();
+
+    for (auto &shard : _shards) {
+        std::ranges::fill(shard.slots, EMPTY_SLOT);
+
+        shard.size = 0;
+    }
+}
+
+auto NameTable::Accepts(std::string_view name) const -> bool {
+    return name.size() <= _maxLength;
+}
+
+auto NameTable::GetName(NameId id) const -> std::string_view {
+    return (*_blocks[id / NAMES_PER_BLOCK])[id % NAMES_PER_BLOCK].GetView();
+}
+
+auto NameTable::GetSize() const -> std::size_t {
+    return _size;
+}
+
+auto NameTable::GetMaxLength() const -> std::size_t {
+    return _maxLength;
+}
+
+auto NameTable::Hash(std::string_view name) -> std::size_t {
+    return std::hash<std::string_view>()(name);
+}
+
+auto NameTable::CheckAccepts(std::string_view name) const -> void {
+    if (!Accepts(name)) {
+        throw std::runtime_error("[ERROR] Name '" + std::string(name) + "' is longer than "
+                                 + std::to_string(_maxLength) + " characters!");
+    }
+}
+
+auto NameTable::FindSlot(const Shard &shard,
+                         std::string_view name,
+                         std::size_t hash) const -> std::size_t {
+    auto mask = shard.slots.size() - 1;
+
+    for (auto slot = GetHomeSlot(shard, hash); ; slot = (slot + 1) & mask) {
+        if (shard.slots[slot] == EMPTY_SLOT || GetName(shard.slots[slot]) == name) {
+            return slot;
+        }
+    }
+}
+
+auto NameTable::PrepareIds(std::size_t count) -> void {
+    auto fresh = count > _freeIds.size() ? count - _freeIds.size() : 0;
+
+    if (_ids + fresh > UINT32_MAX) {
+        throw std::runtime_error("[ERROR] Name table overflow!");
+    }
+
+    // Blocks kept by Clear are reused before new ones are allocated
+    while (_blocks.size() * NAMES_PER_BLOCK < _ids + fresh) {
+        _blocks.push_back(std::make_unique<std::array<FixedName, NAMES_PER_BLOCK>>());
+    }
+
+    if (_references.size() < _ids + fresh) {
+        _references.resize(_ids + fresh);
+    }
+}
+
+auto NameTable::Store(NameId id,
+                      std::string_view name) -> void {
+    (*_blocks[id / NAMES_PER_BLOCK])[id % NAMES_PER_BLOCK] = FixedName(name);
+
+    _references[id] = 1;
+}
+
+auto NameTable::Reserve(Shard &shard,
+                        std::size_t count) -> void {
+    auto slots = std::max<std::size_t>(shard.slots.size(), 16);
+
+    while (2 * (shard.size + count) > slots) {
+        slots *= 2;
+    }
+
+    if (slots != shard.slots.size()) {
+        Rehash(shard, slots);
+    }
+}
+
+auto NameTable::Rehash(Shard &shard,
+                       std::size_t slots) -> void {
+    auto old_slots = std::move(shard.slots);
+
+    shard.slots.assign(slots, EMPTY_SLOT);
+
+    auto mask = slots - 1;
+
+    for (auto id : old_slots) {
+        if (id == EMPTY_SLOT) {
+            continue;
+        }
+
+        auto slot = GetHomeSlot(shard, Hash(GetName(id)));
+
+        while (shard.slots[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+
+        shard.slots[slot] = id;
+    }
+}
+
+auto NameTable::GetShard(std::size_t hash) -> std::size_t {
+    return hash % SHARDS;
+}
+
+auto NameTable::GetHomeSlot(const Shard &shard,
+                            std::size_t hash) -> std::size_t {
+    // The low bits pick the shard, so the slot is taken from the others
+    return (hash / SHARDS) & (shard.slots.size() - 1);
+}
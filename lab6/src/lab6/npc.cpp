@@ -1,5 +1,7 @@
-#include <cmath>
-#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <istream>
+#include <stdexcept>
 
 #include <lab6/npc.h>
 #include <lab6/visitor.h>
@@ -33,9 +35,9 @@ auto StringToNPCType(const std::string &string) -> NPCType {
 }
 
 NPC::NPC(Point point,
-         std::string name)
+         NameId name)
     : _point(point),
-      _name(std::move(name)),
+      _name(name),
       _killed(false) {}
 
 NPC::~NPC() = default;
@@ -46,8 +48,6 @@ auto NPC::Kill() -> void {
 
 auto NPC::CanAttack(const NPC &defender,
                     double distance) const -> bool {
-    const double EPSILON = 1e-9;
-
     if (this == &defender) {
         return false;
     }
@@ -56,18 +56,15 @@ auto NPC::CanAttack(const NPC &defender,
         return false;
     }
 
-    auto x       = _point.GetX(), y                = _point.GetY();
-    auto x_other = defender.GetPoint().GetX(), y_other    = defender.GetPoint().GetY();
-    auto dist_x = x - x_other, dist_y = y - y_other;
-
-    return (distance - std::sqrt(dist_x * dist_x + dist_y * dist_y)) > EPSILON;
+    return InRange<EuclideanMetric>(EuclideanMetric::Distance(_point, defender.GetPoint()),
+                                    distance);
 }
 
 auto NPC::GetPoint() const -> const Point & {
     return _point;
 }
 
-auto NPC::GetName() const -> const std::string & {
+auto NPC::GetNameId() const -> NameId {
     return _name;
 }
 
@@ -76,9 +73,9 @@ auto NPC::GetKilled() const -> bool {
 }
 
 Druid::Druid(Point point,
-             std::string name)
-        : NPC(std::move(point),
-              std::move(name)) {}
+             NameId name)
+        : NPC(point,
+              name) {}
 
 auto Druid::Accept(Visitor *visitor) -> void {
     return visitor->Visit(this);
@@ -89,9 +86,9 @@ auto Druid::GetType() const -> NPCType {
 }
 
 Squirrel::Squirrel(Point point,
-                   std::string name)
+                   NameId name)
         : NPC(point,
-              std::move(name)) {}
+              name) {}
 
 auto Squirrel::Accept(Visitor *visitor) -> void {
     return visitor->Visit(this);
@@ -102,9 +99,9 @@ auto Squirrel::GetType() const -> NPCType {
 }
 
 Werewolf::Werewolf(Point point,
-                   std::string name)
+                   NameId name)
         : NPC(point,
-              std::move(name)) {}
+              name) {}
 
 auto Werewolf::Accept(Visitor *visitor) -> void {
     return visitor->Visit(this);
@@ -114,9 +111,14 @@ auto Werewolf::GetType() const -> NPCType {
     return NPCType::Werewolf;
 }
 
+NPCFactory::NPCFactory(WorldBounds bounds,
+                       std::size_t maxNameLength)
+        : _bounds(bounds),
+          _names(maxNameLength) {}
+
 NPCFactory::~NPCFactory() = default;
 
-auto NPCFactory::LoadNPC(std::istream &istream) const -> NPCPtr {
+auto NPCFactory::LoadNPC(std::istream &istream) -> NPCPtr {
     std::string line;
 
     std::getline(istream, line);
@@ -125,37 +127,87 @@ auto NPCFactory::LoadNPC(std::istream &istream) const -> NPCPtr {
         return nullptr;
     }
 
-    std::istringstream string_stream(line);
+    auto record = ParseNPC(line);
+
+    return CreateNPC(record.type, record.point, record.name);
+}
+
+auto NPCFactory::ParseNPC(std::string_view line) const -> NPCRecord {
+    // Whitespace-separated tokens, as read by operator>> into std::string
+    auto next_token = [&line] () -> std::string_view {
+        const std::string_view WHITESPACE = " \t\n\v\f\r";
 
-    std::string str_type, name, str_point;
-    string_stream >> str_type >> name >> str_point;
+        auto begin = std::min(line.find_first_not_of(WHITESPACE), line.size());
+        auto end   = std::min(line.find_first_of(WHITESPACE, begin), line.size());
 
-    NPCType type  = StringToNPCType(str_type.substr(1, str_type.size() - 2));
-    std::string x = str_point.substr(1, str_point.find(','));
-    std::string y = str_point.substr(str_point.find(',') + 1, str_point.size() - str_point.find(',') - 1);
+        auto token = line.substr(begin, end - begin);
+
+        line.remove_prefix(end);
+
+        return token;
+    };
+
+    auto str_type  = next_token();
+    auto name      = next_token();
+    auto str_point = next_token();
+
+    NPCType type  = StringToNPCType(std::string(str_type.substr(1, str_type.size() - 2)));
+    std::string x(str_point.substr(1, str_point.find(',')));
+    std::string y(str_point.substr(str_point.find(',') + 1, str_point.size() - str_point.find(',') - 1));
     Point point(std::atoi(x.c_str()), std::atoi(y.c_str()));
 
-    return CreateNPC(type, point, name);
+    return NPCRecord { type, point, name };
 }
 
 auto NPCFactory::CreateNPC(NPCType type,
                            Point point,
-                           const std::string &name) const -> NPCPtr {
-    if (point.GetX() > 500 || point.GetY() > 500) {
+                           std::string_view name) -> NPCPtr {
+    if (!_bounds.Contains(point) || !_names.Accepts(name)) {
         return nullptr;
     }
 
+    return CreateNPC(type,
+                     point,
+                     _names.Intern(name));
+}
+
+auto NPCFactory::CreateNPC(NPCType type,
+                           Point point,
+                           NameId name) const -> NPCPtr {
     switch (type) {
         case NPCType::Squirrel:
             return std::make_shared<Squirrel>(point,
-                                              std::move(name));
+                                              name);
         case NPCType::Werewolf:
             return std::make_shared<Werewolf>(point,
-                                              std::move(name));
+                                              name);
         case NPCType::Druid:
             return std::make_shared<Druid>(point,
-                                           std::move(name));
+                                           name);
     }
 
     throw std::runtime_error("[INTERNAL] Missed NPC type handling in NPCFactory::CreateNPC!");
 }
+
+auto NPCFactory::InternNames(const std::vector<std::string_view> &names,
+                             const std::vector<std::size_t> &hashes,
+                             std::vector<NameId> &ids,
+                             std::size_t workers) -> void {
+    _names.InternAll(names, hashes, ids, workers);
+}
+
+auto NPCFactory::ReleaseName(NameId id) -> void {
+    _names.Release(id);
+}
+
+auto NPCFactory::ClearNames() -> void {
+    _names.Clear();
+}
+
+auto NPCFactory::GetNames() const -> const NameTable & {
+    return _names;
+}
+
+auto NPCFactory::GetBounds() const -> const WorldBounds & {
+    return _bounds;
+}
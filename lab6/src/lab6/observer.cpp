@@ -7,25 +7,106 @@
 Observer::~Observer() = default;
 
 auto Observer::OnKillMessage(const NPC &killer,
-                             const NPC &killed) -> std::string {
+                             const NPC &killed,
+                             const NameTable &names) -> std::string {
     std::ostringstream string_stream;
 
-    string_stream << "[" << killed.GetName() << "] killed by [" << killer.GetName() << "]!";
+    string_stream << "[" << names.GetName(killed.GetNameId()) << "] killed by [" << names.GetName(killer.GetNameId()) << "]!";
 
     return string_stream.str();
 }
 
+auto Observer::OnBattleEnd() -> void {}
+
+auto KillRegion::Contains(Point point) const -> bool {
+    return point.GetX() >= min.GetX() && point.GetX() <= max.GetX()
+        && point.GetY() >= min.GetY() && point.GetY() <= max.GetY();
+}
+
 Logger::Logger(std::ofstream file)
         : _file(std::move(file)) {}
 
 auto Logger::OnKill(const NPC &killer,
-                    const NPC &killed) -> void {
-    _file << OnKillMessage(killer, killed) << std::endl;
+                    const NPC &killed,
+                    const NameTable &names) -> void {
+    _file << OnKillMessage(killer, killed, names) << std::endl;
 
     _file.flush();
 }
 
+Screen::Screen(ScreenMode mode,
+               std::size_t linesPerSecond,
+               std::ostream &ostream)
+        : _mode(mode),
+          _ostream(ostream),
+          _kills {},
+          _linesPerSecond(linesPerSecond),
+          _windowStart(),
+          _windowLines(0),
+          _suppressed(0) {}
+
 auto Screen::OnKill(const NPC &killer,
-                    const NPC &killed) -> void {
-    std::cout << OnKillMessage(killer, killed) << std::endl;
+                    const NPC &killed,
+                    const NameTable &names) -> void {
+    switch (_mode) {
+        case ScreenMode::Full:
+            _ostream << OnKillMessage(killer, killed, names) << std::endl;
+
+            break;
+        case ScreenMode::Summary:
+            ++_kills[static_cast<std::size_t>(killer.GetType())][static_cast<std::size_t>(killed.GetType())];
+
+            break;
+        case ScreenMode::Sampled: {
+            auto now = std::chrono::steady_clock::now();
+
+            if (now - _windowStart >= std::chrono::seconds(1)) {
+                _windowStart = now;
+                _windowLines = 0;
+            }
+
+            if (_windowLines < _linesPerSecond) {
+                _ostream << OnKillMessage(killer, killed, names) << '\n';
+
+                ++_windowLines;
+            }
+            else {
+                ++_suppressed;
+            }
+
+            break;
+        }
+    }
+}
+
+auto Screen::OnBattleEnd() -> void {
+    if (_mode == ScreenMode::Summary) {
+        std::uint64_t total = 0;
+
+        _ostream << "Battle summary:\n";
+
+        for (std::size_t killer = 0; killer < NPC_TYPES_COUNT; ++killer) {
+            for (std::size_t killed = 0; killed < NPC_TYPES_COUNT; ++killed) {
+                if (_kills[killer][killed] == 0) {
+                    continue;
+                }
+
+                _ostream << "  [" << NPCTypeToString(static_cast<NPCType>(killer)) << "] killed ["
+                         << NPCTypeToString(static_cast<NPCType>(killed)) << "]: " << _kills[killer][killed] << '\n';
+
+                total += _kills[killer][killed];
+            }
+        }
+
+        _ostream << "  Total kills: " << total << '\n';
+
+        _kills = {};
+    }
+    else if (_mode == ScreenMode::Sampled && _suppressed != 0) {
+        _ostream << "... " << _suppressed << " more kills not shown\n";
+
+        _suppressed = 0;
+    }
+
+    _ostream.flush();
 }
@@ -0,0 +1,8 @@
+#include <algorithm>
+
+#include <lab6/parallel.h>
+
+
+auto GetWorkersCount() -> std::size_t {
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
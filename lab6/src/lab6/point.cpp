@@ -1,15 +1,17 @@
+#include <algorithm>
+
 #include <lab6/point.h>
 
 
 Point::Point(std::uint64_t x,
              std::uint64_t y)
-        : _x(x),
-          _y(y) {}
+        : _x(static_cast<Coordinate>(std::min(x, COORDINATE_LIMIT))),
+          _y(static_cast<Coordinate>(std::min(y, COORDINATE_LIMIT))) {}
 
-auto Point::GetX() const -> std::uint64_t {
+auto Point::GetX() const -> Coordinate {
     return _x;
 }
 
-auto Point::GetY() const -> std::uint64_t {
+auto Point::GetY() const -> Coordinate {
     return _y;
 }
@@ -0,0 +1,134 @@
+#include <queue>
+#include <utility>
+
+#include <lab6/metric.h>
+#include <lab6/spatial_index.h>
+
+
+SpatialIndex::SpatialIndex(const WorldBounds &bounds,
+                           std::uint64_t cellSize)
+        : _maxX(bounds.GetMaxX()),
+          _maxY(bounds.GetMaxY()),
+          _cellSize(0),
+          _columns(0),
+          _rows(0) {
+    Reset(cellSize);
+}
+
+auto SpatialIndex::Insert(std::uint32_t index,
+                          Point point) -> void {
+    GetCell(point).push_back(Entry { index, point });
+}
+
+auto SpatialIndex::Clear() -> void {
+    for (auto &cell : _cells) {
+        cell.clear();
+    }
+}
+
+auto SpatialIndex::Reset(std::uint64_t cellSize) -> void {
+    _cellSize = FitCellSize(cellSize);
+    _columns  = _maxX / _cellSize + 1;
+    _rows     = _maxY / _cellSize + 1;
+
+    _cells.clear();
+    _cells.resize(_columns * _rows);
+}
+
+auto SpatialIndex::FitCellSize(std::uint64_t cellSize) const -> std::uint64_t {
+    cellSize = std::max<std::uint64_t>(cellSize, 1);
+
+    while ((_maxX / cellSize + 1) * (_maxY / cellSize + 1) > MAX_CELLS) {
+        ++cellSize;
+    }
+
+    return cellSize;
+}
+
+auto SpatialIndex::GetCellSize() const -> std::uint64_t {
+    return _cellSize;
+}
+
+auto SpatialIndex::GetRow(Point point) const -> std::uint64_t {
+    return std::min<std::uint64_t>(point.GetY(), _maxY) / _cellSize;
+}
+
+auto SpatialIndex::GetRowsCount() const -> std::uint64_t {
+    return _rows;
+}
+
+auto SpatialIndex::QueryKNearest(Point center,
+                                 std::size_t count) const -> std::vector<std::uint32_t> {
+    // Max-heap of the best candidates so far, ordered by (distance, index)
+    using Candidate = std::pair<std::uint64_t, std::uint32_t>;
+
+    std::priority_queue<Candidate> best;
+
+    if (count == 0) {
+        return {};
+    }
+
+    auto center_x = static_cast<std::int64_t>(std::min<std::uint64_t>(center.GetX(), _maxX) / _cellSize);
+    auto center_y = static_cast<std::int64_t>(std::min<std::uint64_t>(center.GetY(), _maxY) / _cellSize);
+    auto columns  = static_cast<std::int64_t>(_columns);
+    auto rows     = static_cast<std::int64_t>(_rows);
+
+    auto visit_cell = [&] (std::int64_t cell_x, std::int64_t cell_y) -> void {
+        if (cell_x < 0 || cell_y < 0 || cell_x >= columns || cell_y >= rows) {
+            return;
+        }
+
+        for (const auto &entry : _cells[cell_y * columns + cell_x]) {
+            Candidate candidate(EuclideanMetric::Distance(center, entry.point), entry.index);
+
+            if (best.size() < count) {
+                best.push(candidate);
+            }
+            else if (candidate < best.top()) {
+                best.pop();
+                best.push(candidate);
+            }
+        }
+    };
+
+    // Cells at ring r + 1 are farther than r * cell size from the center,
+    // so the search stops once the k-th candidate is closer than that
+    for (std::int64_t ring = 0; ring < std::max(columns, rows); ++ring) {
+        if (ring == 0) {
+            visit_cell(center_x, center_y);
+        }
+        else {
+            for (auto offset = -ring; offset <= ring; ++offset) {
+                visit_cell(center_x + offset, center_y - ring);
+                visit_cell(center_x + offset, center_y + ring);
+            }
+
+            for (auto offset = -ring + 1; offset <= ring - 1; ++offset) {
+                visit_cell(center_x - ring, center_y + offset);
+                visit_cell(center_x + ring, center_y + offset);
+            }
+        }
+
+        auto bound = static_cast<std::uint64_t>(ring) * _cellSize;
+
+        if (best.size() == count && best.top().first <= bound * bound) {
+            break;
+        }
+    }
+
+    std::vector<std::uint32_t> indices(best.size());
+
+    for (auto it = indices.rbegin(); it != indices.rend(); ++it) {
+        *it = best.top().second;
+
+        best.pop();
+    }
+
+    return indices;
+}
+
+auto SpatialIndex::GetCell(Point point) -> std::vector<Entry> & {
+    auto cell_x = std::min<std::uint64_t>(point.GetX(), _maxX) / _cellSize;
+
+    return _cells[GetRow(point) * _columns + cell_x];
+}
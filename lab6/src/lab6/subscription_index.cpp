@@ -0,0 +1,54 @@
+#include <algorithm>
+
+#include <lab6/subscription_index.h>
+
+
+SubscriptionIndex::SubscriptionIndex(const WorldBounds &bounds)
+        : _cellWidth(bounds.GetMaxX() / REGION_GRID_SIZE + 1),
+          _cellHeight(bounds.GetMaxY() / REGION_GRID_SIZE + 1) {}
+
+auto SubscriptionIndex::Add(const ObserverPtr &observer,
+                            const ObserverFilter &filter) -> void {
+    auto number = static_cast<std::uint32_t>(_subscribers.size());
+
+    _subscribers.push_back(Subscriber { observer, filter.region });
+
+    for (std::size_t killer = 0; killer < NPC_TYPES_COUNT; ++killer) {
+        for (std::size_t victim = 0; victim < NPC_TYPES_COUNT; ++victim) {
+            if (!(filter.killers & NPCTypeMask(static_cast<NPCType>(killer)))
+                || !(filter.victims & NPCTypeMask(static_cast<NPCType>(victim)))) {
+                continue;
+            }
+
+            auto &pair = _pairs[killer * NPC_TYPES_COUNT + victim];
+
+            if (!filter.region) {
+                pair.everywhere.push_back(number);
+
+                continue;
+            }
+
+            if (pair.cells.empty()) {
+                pair.cells.resize(REGION_GRID_SIZE * REGION_GRID_SIZE);
+            }
+
+            auto min_x = std::min<std::uint64_t>(filter.region->min.GetX() / _cellWidth, REGION_GRID_SIZE - 1);
+            auto min_y = std::min<std::uint64_t>(filter.region->min.GetY() / _cellHeight, REGION_GRID_SIZE - 1);
+            auto max_x = std::min<std::uint64_t>(filter.region->max.GetX() / _cellWidth, REGION_GRID_SIZE - 1);
+            auto max_y = std::min<std::uint64_t>(filter.region->max.GetY() / _cellHeight, REGION_GRID_SIZE - 1);
+
+            for (auto cell_y = min_y; cell_y <= max_y; ++cell_y) {
+                for (auto cell_x = min_x; cell_x <= max_x; ++cell_x) {
+                    pair.cells[cell_y * REGION_GRID_SIZE + cell_x].push_back(number);
+                }
+            }
+        }
+    }
+}
+
+auto SubscriptionIndex::GetCell(Point point) const -> std::size_t {
+    auto cell_x = std::min<std::uint64_t>(point.GetX() / _cellWidth, REGION_GRID_SIZE - 1);
+    auto cell_y = std::min<std::uint64_t>(point.GetY() / _cellHeight, REGION_GRID_SIZE - 1);
+
+    return cell_y * REGION_GRID_SIZE + cell_x;
+}
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <fstream>
+
+#include <lab6/trace.h>
+
+
+auto Tracer::Get() -> Tracer & {
+    static Tracer tracer;
+
+    return tracer;
+}
+
+auto Tracer::Enable() -> void {
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+auto Tracer::Disable() -> void {
+    _enabled.store(false, std::memory_order_relaxed);
+}
+
+auto Tracer::IsEnabled() const -> bool {
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+auto Tracer::Record(const char *name,
+                    const char *category,
+                    std::int64_t start,
+                    std::int64_t end) -> void {
+    GetThreadBuffer().events.push_back(TraceEvent { name, category, start, end - start });
+}
+
+auto Tracer::Write(std::ostream &ostream) const -> void {
+    std::lock_guard lock(_mutex);
+
+    auto microseconds = [] (std::int64_t nanoseconds) -> std::string {
+        auto text = std::to_string(nanoseconds / 1000) + ".";
+        auto rest = std::to_string(nanoseconds % 1000);
+
+        return text + std::string(3 - rest.size(), '0') + rest;
+    };
+
+    ostream << "{\"traceEvents\":[";
+
+    auto first = true;
+
+    for (const auto &buffer : _buffers) {
+        ostream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+                << ",\"args\":{\"name\":\"thread " << buffer->thread << "\"}}";
+
+        first = false;
+
+        for (const auto &event : buffer->events) {
+            ostream << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                    << "\",\"ph\":\"X\",\"ts\":" << microseconds(event.start)
+                    << ",\"dur\":" << microseconds(event.duration)
+                    << ",\"pid\":1,\"tid\":" << buffer->thread << "}";
+        }
+    }
+
+    ostream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+auto Tracer::WriteFile(const std::string &filename) const -> int32_t {
+    std::ofstream file(filename);
+
+    if (!file.is_open()) {
+        return 1;
+    }
+
+    Write(file);
+
+    file.close();
+
+    return 0;
+}
+
+auto Tracer::Clear() -> void {
+    std::lock_guard lock(_mutex);
+
+    for (auto &buffer : _buffers) {
+        buffer->events.clear();
+    }
+}
+
+auto Tracer::Now() -> std::int64_t {
+    static const auto epoch = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+Tracer::Tracer()
+        : _enabled(false) {}
+
+auto Tracer::GetThreadBuffer() -> ThreadBuffer & {
+    // Shared with _buffers, so spans of finished threads are still written
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+    if (!buffer) {
+        std::lock_guard lock(_mutex);
+
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->thread = static_cast<std::uint32_t>(_buffers.size() + 1);
+
+        _buffers.push_back(buffer);
+    }
+
+    return *buffer;
+}
+
+TraceSpan::TraceSpan(const char *name,
+                     const char *category)
+        : _name(name),
+          _category(category),
+          _start(Tracer::Get().IsEnabled() ? Tracer::Now() : -1) {}
+
+TraceSpan::~TraceSpan() {
+    if (_start >= 0) {
+        Tracer::Get().Record(_name, _category, _start, Tracer::Now());
+    }
+}
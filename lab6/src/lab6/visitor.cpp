@@ -13,30 +13,22 @@ auto Battle::SetTarget(const NPCPtr &target) -> void {
 }
 
 auto Battle::Visit(Druid *druid) -> void {
-    (void) druid;
+    if (_game.GetRules().CanKill(druid->GetType(), _target->GetType())) {
+        _target->Kill();
+        _game.NotifyKill(*druid, *_target);
+    }
 }
 
 auto Battle::Visit(Squirrel *squirrel) -> void {
-    switch (_target->GetType()) {
-        case NPCType::Werewolf:
-        case NPCType::Druid:
-            _target->Kill();
-            _game.NotifyKill(*squirrel, *_target);
-
-            break;
-        default:
-            break;
+    if (_game.GetRules().CanKill(squirrel->GetType(), _target->GetType())) {
+        _target->Kill();
+        _game.NotifyKill(*squirrel, *_target);
     }
 }
 
 auto Battle::Visit(Werewolf *werewolf) -> void {
-    switch (_target->GetType()) {
-        case NPCType::Druid:
-            _target->Kill();
-            _game.NotifyKill(*werewolf, *_target);
-
-            break;
-        default:
-            break;
+    if (_game.GetRules().CanKill(werewolf->GetType(), _target->GetType())) {
+        _target->Kill();
+        _game.NotifyKill(*werewolf, *_target);
     }
 }
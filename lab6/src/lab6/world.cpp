@@ -0,0 +1,25 @@
+#include <stdexcept>
+
+#include <lab6/world.h>
+
+
+WorldBounds::WorldBounds(std::uint64_t maxX,
+                         std::uint64_t maxY)
+        : _maxX(static_cast<Coordinate>(maxX)),
+          _maxY(static_cast<Coordinate>(maxY)) {
+    if (maxX >= COORDINATE_LIMIT || maxY >= COORDINATE_LIMIT) {
+        throw std::runtime_error("[ERROR] World bounds exceed the coordinate width!");
+    }
+}
+
+auto WorldBounds::Contains(Point point) const -> bool {
+    return point.GetX() <= _maxX && point.GetY() <= _maxY;
+}
+
+auto WorldBounds::GetMaxX() const -> Coordinate {
+    return _maxX;
+}
+
+auto WorldBounds::GetMaxY() const -> Coordinate {
+    return _maxY;
+}
@@ -4,7 +4,9 @@
 
 #include <gtest/gtest.h>
 
+#include <lab6/batch.h>
 #include <lab6/game.h>
+#include <lab6/trace.h>
 #include <lab6/visitor.h>
 
 
@@ -25,6 +27,110 @@ protected:
     std::unique_ptr<Game> game;
 };
 
+class KillRecorder : public Observer {
+public:
+    auto OnKill(const NPC &killer,
+                const NPC &killed,
+                const NameTable &names) -> void override {
+        kills.push_back(OnKillMessage(killer, killed, names));
+    }
+
+    std::vector<std::string> kills;
+};
+
+// Эталонный бой: полный перебор пар, как в исходной реализации
+template<typename Metric>
+auto ReferenceBattle(const std::vector<NPCPtr> &npcs,
+                     double distance,
+                     Game &notifier) -> std::vector<std::string> {
+    Battle battle(notifier);
+
+    for (const auto &defender : npcs) {
+        battle.SetTarget(defender);
+
+        for (const auto &attacker : npcs) {
+            if (attacker == defender || attacker->GetKilled() || defender->GetKilled()) {
+                continue;
+            }
+
+            if (!InRange<Metric>(Metric::Distance(attacker->GetPoint(), defender->GetPoint()), distance)) {
+                continue;
+            }
+
+            attacker->Accept(&battle);
+
+            if (defender->GetKilled()) {
+                break;
+            }
+        }
+    }
+
+    std::vector<std::string> survivors;
+
+    for (const auto &npc : npcs) {
+        if (!npc->GetKilled()) {
+            survivors.emplace_back(notifier.GetName(*npc));
+        }
+    }
+
+    return survivors;
+}
+
+using GeneratedNPC = std::tuple<NPCType, Point, std::string>;
+
+// Детерминированный мир: count NPC всех типов, разбросанных по квадрату side x side
+auto GenerateNPCs(int count,
+                  int side) -> std::vector<GeneratedNPC> {
+    std::vector<GeneratedNPC> npcs;
+
+    for (int i = 0; i < count; ++i) {
+        npcs.emplace_back(static_cast<NPCType>(i % 3), Point((i * 37) % side, (i * 53) % side), "NPC_" + std::to_string(i));
+    }
+
+    return npcs;
+}
+
+auto PopulateWorld(Game &game,
+                   int count,
+                   int side) -> void {
+    for (const auto &[type, point, name] : GenerateNPCs(count, side)) {
+        game.AddNPC(type, point, name);
+    }
+}
+
+template<typename Metric>
+auto ExpectBattleMatchesReference(const NPCFactoryPtr &factory,
+                                  double distance,
+                                  BattleRules rules = BattleRules()) -> void {
+    Game game(factory, rules);
+    auto game_log = std::make_shared<KillRecorder>();
+    game.AddObserver(game_log);
+
+    Game notifier(factory, rules);
+    auto reference_log = std::make_shared<KillRecorder>();
+    notifier.AddObserver(reference_log);
+
+    std::vector<NPCPtr> npcs;
+
+    for (const auto &[type, point, name] : GenerateNPCs(400, 160)) {
+        game.AddNPC(type, point, name);
+        npcs.push_back(factory->CreateNPC(type, point, name));
+    }
+
+    auto expected = ReferenceBattle<Metric>(npcs, distance, notifier);
+
+    game.template StartBattle<Metric>(distance);
+
+    std::vector<std::string> actual;
+
+    for (const auto *npc : game.QueryRect(Point(0, 0), Point(MAX_COORDINATE, MAX_COORDINATE))) {
+        actual.emplace_back(game.GetName(*npc));
+    }
+
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(game_log->kills, reference_log->kills);
+}
+
 // Тесты для класса Point
 TEST(PointTest, ConstructorAndGetters) {
     Point point(10, 20);
@@ -32,13 +138,46 @@ TEST(PointTest, ConstructorAndGetters) {
     EXPECT_EQ(point.GetY(), 20);
 }
 
+TEST(PointTest, CompactAndSaturating) {
+    EXPECT_EQ(sizeof(Point), 2 * sizeof(Coordinate));
+
+    Point point(1'000'000, 7);
+    EXPECT_EQ(point.GetX(), COORDINATE_LIMIT);
+    EXPECT_EQ(point.GetY(), 7);
+}
+
+TEST(WorldBoundsTest, Contains) {
+    WorldBounds bounds(100, 50);
+
+    EXPECT_TRUE(bounds.Contains(Point(0, 0)));
+    EXPECT_TRUE(bounds.Contains(Point(100, 50)));
+    EXPECT_FALSE(bounds.Contains(Point(101, 50)));
+    EXPECT_FALSE(bounds.Contains(Point(100, 51)));
+    EXPECT_FALSE(bounds.Contains(Point(1'000'000, 0)));
+
+    EXPECT_THROW(WorldBounds(COORDINATE_LIMIT, 0), std::runtime_error);
+}
+
+TEST(WorldBoundsTest, FactoryUsesBounds) {
+    auto factory = std::make_shared<NPCFactory>(WorldBounds(2000, 2000));
+    Game game(factory);
+
+    EXPECT_EQ(game.AddNPC(NPCType::Druid, Point(1500, 1999), "Far"), 0);
+    EXPECT_NE(game.AddNPC(NPCType::Druid, Point(2001, 0), "TooFar"), 0);
+
+    auto npcs = game.QueryKNearest(Point(2000, 2000), 1);
+
+    ASSERT_EQ(npcs.size(), 1);
+    EXPECT_EQ(game.GetName(*npcs[0]), "Far");
+}
+
 // Тесты для NPC
 TEST_F(GameTest, NPCCreationAndProperties) {
     Point point(5, 5);
     auto druid = factory->CreateNPC(NPCType::Druid, point, "Druid1");
 
     EXPECT_EQ(druid->GetType(), NPCType::Druid);
-    EXPECT_EQ(druid->GetName(), "Druid1");
+    EXPECT_EQ(game->GetName(*druid), "Druid1");
     EXPECT_FALSE(druid->GetKilled());
     EXPECT_EQ(druid->GetPoint().GetX(), 5);
     EXPECT_EQ(druid->GetPoint().GetY(), 5);
@@ -53,6 +192,215 @@ TEST_F(GameTest, NPCKillMethod) {
     EXPECT_TRUE(squirrel->GetKilled());
 }
 
+// Тесты для таблицы имён
+TEST(NameTableTest, InternReturnsSameIdForSameName) {
+    NameTable names;
+
+    auto first = names.Intern("Druid1");
+    auto second = names.Intern("Druid2");
+
+    EXPECT_NE(first, second);
+    EXPECT_EQ(names.Intern("Druid1"), first);
+    EXPECT_EQ(names.GetName(first), "Druid1");
+    EXPECT_EQ(names.GetName(second), "Druid2");
+    EXPECT_EQ(names.GetSize(), 2);
+}
+
+TEST(NameTableTest, NamesStayValidAcrossBlocks) {
+    NameTable names;
+
+    const std::size_t COUNT = 3 * NameTable::NAMES_PER_BLOCK + 5;
+
+    for (std::size_t i = 0; i < COUNT; ++i) {
+        EXPECT_EQ(names.Intern("NPC_" + std::to_string(i)), i);
+    }
+
+    auto first = names.GetName(0);
+
+    for (std::size_t i = 0; i < COUNT; ++i) {
+        EXPECT_EQ(names.Intern("NPC_" + std::to_string(i)), i);
+        EXPECT_EQ(names.GetName(static_cast<NameId>(i)), "NPC_" + std::to_string(i));
+    }
+
+    // Ранее выданные представления имён не инвалидируются
+    EXPECT_EQ(first, "NPC_0");
+    EXPECT_EQ(names.GetSize(), COUNT);
+}
+
+TEST(NameTableTest, ClearForgetsNames) {
+    NameTable names;
+
+    for (std::size_t i = 0; i < NameTable::NAMES_PER_BLOCK + 1; ++i) {
+        names.Intern("Old_" + std::to_string(i));
+    }
+
+    names.Clear();
+
+    EXPECT_EQ(names.GetSize(), 0);
+
+    // Идентификаторы снова выдаются с нуля, старые имена не находятся
+    EXPECT_EQ(names.Intern("New_0"), 0);
+    EXPECT_EQ(names.Intern("Old_0"), 1);
+    EXPECT_EQ(names.Intern("New_0"), 0);
+    EXPECT_EQ(names.GetName(1), "Old_0");
+    EXPECT_EQ(names.GetSize(), 2);
+}
+
+TEST(NameTableTest, ReleaseReusesIds) {
+    NameTable names;
+
+    const std::size_t COUNT = 2 * NameTable::NAMES_PER_BLOCK;
+
+    for (std::size_t i = 0; i < COUNT; ++i) {
+        names.Intern("NPC_" + std::to_string(i));
+    }
+
+    // Имя с двумя ссылками остаётся после одного освобождения
+    names.Intern("NPC_0");
+    names.Release(0);
+
+    for (std::size_t i = 1; i < COUNT; i += 2) {
+        names.Release(static_cast<NameId>(i));
+    }
+
+    EXPECT_EQ(names.GetSize(), COUNT / 2);
+
+    // Оставшиеся имена находятся после удаления соседей по цепочке проб
+    for (std::size_t i = 0; i < COUNT; i += 2) {
+        EXPECT_EQ(names.Intern("NPC_" + std::to_string(i)), i);
+    }
+
+    // Новые имена занимают освобождённые идентификаторы
+    for (std::size_t i = 0; i < COUNT / 2; ++i) {
+        auto id = names.Intern("New_" + std::to_string(i));
+
+        EXPECT_EQ(id % 2, 1);
+        EXPECT_EQ(names.GetName(id), "New_" + std::to_string(i));
+    }
+
+    EXPECT_EQ(names.GetSize(), COUNT);
+    EXPECT_LT(names.Intern("Next"), COUNT + 1);
+}
+
+TEST(NameTableTest, InternAllMatchesIntern) {
+    std::vector<std::string> texts;
+
+    for (std::size_t i = 0; i < 3000; ++i) {
+        texts.push_back("NPC_" + std::to_string(i % 2000));
+    }
+
+    for (std::size_t workers : { 1, 3, 100 }) {
+        NameTable names;
+
+        // Уже известные имена и освобождённые идентификаторы
+        for (std::size_t i = 1500; i < 2500; ++i) {
+            names.Intern("NPC_" + std::to_string(i));
+        }
+
+        for (NameId id = 0; id < 1000; id += 2) {
+            names.Release(id);
+        }
+
+        std::vector<std::string_view> views(texts.begin(), texts.end());
+        std::vector<std::size_t> hashes;
+        std::vector<NameId> ids;
+
+        for (auto view : views) {
+            hashes.push_back(NameTable::Hash(view));
+        }
+
+        names.InternAll(views, hashes, ids, workers);
+
+        ASSERT_EQ(ids.size(), texts.size());
+
+        for (std::size_t i = 0; i < texts.size(); ++i) {
+            EXPECT_EQ(names.GetName(ids[i]), texts[i]) << workers;
+            EXPECT_EQ(ids[i], ids[i % 2000]) << workers;
+        }
+
+        // 2000 имён из пакета и 250 старых вне его, новые заняли свободные идентификаторы
+        EXPECT_EQ(names.GetSize(), 2250) << workers;
+        EXPECT_LT(*std::ranges::max_element(ids), 2250) << workers;
+
+        // Каждое вхождение взяло свою ссылку
+        for (std::size_t i = 0; i < texts.size(); ++i) {
+            names.Release(ids[i]);
+        }
+
+        EXPECT_EQ(names.GetSize(), 500) << workers;
+        EXPECT_EQ(names.Intern("NPC_2499"), names.Intern("NPC_2499")) << workers;
+    }
+}
+
+TEST(NameTableTest, GameReleasesNamesOfRemovedNPCs) {
+    auto factory = std::make_shared<NPCFactory>();
+
+    {
+        Game game(factory);
+        game.SetDumpStream(nullptr);
+
+        game.AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+        game.AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+        game.AddNPC(NPCType::Druid, Point(12, 12), "Werewolf1");
+
+        EXPECT_EQ(factory->GetNames().GetSize(), 2);
+
+        game.StartBattle(5.0);
+
+        // Имя убитого освобождено, его можно снова использовать
+        EXPECT_EQ(factory->GetNames().GetSize(), 1);
+        EXPECT_EQ(game.AddNPC(NPCType::Druid, Point(300, 300), "Druid1"), 0);
+        EXPECT_EQ(factory->GetNames().GetSize(), 2);
+
+        game.Clear();
+
+        EXPECT_EQ(factory->GetNames().GetSize(), 0);
+
+        game.AddNPC(NPCType::Squirrel, Point(1, 1), "Squirrel1");
+    }
+
+    EXPECT_EQ(factory->GetNames().GetSize(), 0);
+}
+
+TEST(NameTableTest, MaxLength) {
+    NameTable names(5);
+
+    EXPECT_TRUE(names.Accepts("Druid"));
+    EXPECT_FALSE(names.Accepts("Druid1"));
+    EXPECT_EQ(names.GetName(names.Intern("Druid")), "Druid");
+    EXPECT_THROW(names.Intern("Druid1"), std::runtime_error);
+
+    EXPECT_EQ(NameTable().GetMaxLength(), MAX_NAME_LENGTH);
+    EXPECT_THROW(NameTable(MAX_NAME_LENGTH + 1), std::runtime_error);
+
+    std::string longest(MAX_NAME_LENGTH, 'x');
+    NameTable full;
+
+    EXPECT_EQ(full.GetName(full.Intern(longest)), longest);
+}
+
+TEST(NameTableTest, FactoryRejectsLongNames) {
+    auto factory = std::make_shared<NPCFactory>(WorldBounds(), 8);
+    Game game(factory);
+
+    EXPECT_EQ(game.AddNPC(NPCType::Druid, Point(1, 1), "Druid001"), 0);
+    EXPECT_NE(game.AddNPC(NPCType::Druid, Point(2, 2), "Druid0002"), 0);
+    EXPECT_EQ(factory->CreateNPC(NPCType::Druid, Point(3, 3), "Druid0003"), nullptr);
+
+    std::istringstream line("[Werewolf] Werewolf001 [5,5]\n");
+    EXPECT_EQ(factory->LoadNPC(line), nullptr);
+
+    EXPECT_EQ(factory->GetNames().GetSize(), 1);
+}
+
+TEST_F(GameTest, NPCsShareInternedName) {
+    auto druid = factory->CreateNPC(NPCType::Druid, Point(1, 1), "Shared");
+    auto squirrel = factory->CreateNPC(NPCType::Squirrel, Point(2, 2), "Shared");
+
+    EXPECT_EQ(druid->GetNameId(), squirrel->GetNameId());
+    EXPECT_EQ(factory->GetNames().GetSize(), 1);
+}
+
 // Тесты для Game - добавление NPC
 TEST_F(GameTest, AddNPC) {
     Point point1(10, 10);
@@ -65,6 +413,20 @@ TEST_F(GameTest, AddNPC) {
     EXPECT_EQ(status2, 0);
 }
 
+TEST_F(GameTest, AddNPCDuplicateName) {
+    EXPECT_EQ(game->AddNPC(NPCType::Druid, Point(1, 1), "Twin"), 0);
+    EXPECT_NE(game->AddNPC(NPCType::Werewolf, Point(2, 2), "Twin"), 0);
+}
+
+TEST_F(GameTest, KilledNameCanBeReused) {
+    game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+    game->AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+
+    game->StartBattle(5.0);
+
+    EXPECT_EQ(game->AddNPC(NPCType::Druid, Point(400, 400), "Druid1"), 0);
+}
+
 TEST_F(GameTest, AddNPCInvalidCoordinates) {
     // Предполагаем, что координаты должны быть в пределах [0, 500]
     Point point(600, 600); // Вне допустимого диапазона
@@ -103,6 +465,128 @@ TEST_F(GameTest, SaveAndLoadObjects) {
     EXPECT_NE(output.find("Werewolf1"), std::string::npos);
 }
 
+// Последовательная загрузка построчно, как в исходной реализации
+auto LoadSequentially(Game &game,
+                      NPCFactory &factory,
+                      const std::string &filename) -> std::string {
+    std::ifstream file(filename);
+
+    std::ostringstream dump;
+
+    try {
+        while (auto npc = factory.LoadNPC(file)) {
+            if (game.AddNPC(npc->GetType(), npc->GetPoint(), factory.GetNames().GetName(npc->GetNameId()))) {
+                break;
+            }
+        }
+    }
+    catch (const std::exception &) {
+        dump << "<error>";
+    }
+
+    game.DumpObjects(dump);
+
+    return dump.str();
+}
+
+auto LoadInChunks(Game &game,
+                  const std::string &filename,
+                  std::size_t workers) -> std::string {
+    std::ostringstream dump;
+
+    try {
+        game.LoadObjects(filename, workers);
+    }
+    catch (const std::exception &) {
+        dump << "<error>";
+    }
+
+    game.DumpObjects(dump);
+
+    return dump.str();
+}
+
+TEST_F(GameTest, ChunkedLoadMatchesSequentialLoad) {
+    const std::vector<std::string> TAILS = {
+        "",
+        "[Druid] NPC_7 [1,1]\n[Druid] After [2,2]\n",
+        "[Druid] Outside [501,1]\n[Druid] After [2,2]\n",
+        "[Druid] NameLongerThanThirtyOneCharacters [1,1]\n[Druid] After [2,2]\n",
+        "[Dragon] Unknown [1,1]\n[Druid] After [2,2]\n",
+        "\n[Druid] After [2,2]\n",
+        "[Druid] Unterminated [3,3]",
+    };
+
+    for (const auto &tail : TAILS) {
+        {
+            std::ofstream file("test_save.txt");
+
+            for (const auto &[type, point, name] : GenerateNPCs(2000, 501)) {
+                file << "[" << NPCTypeToString(type) << "] " << name
+                     << " [" << point.GetX() << "," << point.GetY() << "]\n";
+            }
+
+            file << tail;
+
+            // Строки после места остановки попадают в следующие фрагменты
+            if (tail.ends_with('\n')) {
+                for (int i = 0; i < 1000; ++i) {
+                    file << "[Squirrel] Late_" << i << " [" << (i * 11) % 501 << "," << (i * 7) % 501 << "]\n";
+                }
+            }
+        }
+
+        Game sequential(factory);
+        auto expected = LoadSequentially(sequential, *factory, "test_save.txt");
+
+        for (std::size_t workers : { 1, 2, 3, 7 }) {
+            Game chunked(factory);
+
+            EXPECT_EQ(LoadInChunks(chunked, "test_save.txt", workers), expected) << tail << " " << workers;
+        }
+    }
+}
+
+TEST_F(GameTest, LoadReportsRejectedName) {
+    {
+        std::ofstream file("test_save.txt");
+
+        for (int i = 0; i < 100; ++i) {
+            file << "[Druid] NPC_" << i << " [" << i << "," << i << "]\n";
+        }
+
+        file << "[Druid] " << std::string(MAX_NAME_LENGTH + 1, 'x') << " [1,1]\n";
+        file << "[Druid] After [2,2]\n";
+    }
+
+    for (std::size_t workers : { 1, 3 }) {
+        Game loaded(std::make_shared<NPCFactory>());
+
+        // Строки до слишком длинного имени загружены, но загрузка сообщает об ошибке
+        EXPECT_EQ(loaded.LoadObjects("test_save.txt", workers), 1) << workers;
+        EXPECT_EQ(loaded.CountNPCs(NPCType::Druid), 100) << workers;
+    }
+}
+
+TEST_F(GameTest, ParseNPCTokens) {
+    auto record = factory->ParseNPC("  [Werewolf]\tWolf   [12,345]\r");
+
+    EXPECT_EQ(record.type, NPCType::Werewolf);
+    EXPECT_EQ(record.name, "Wolf");
+    EXPECT_EQ(record.point.GetX(), 12);
+    EXPECT_EQ(record.point.GetY(), 345);
+
+    EXPECT_THROW(factory->ParseNPC(""), std::out_of_range);
+    EXPECT_THROW(factory->ParseNPC("[Dragon] Smaug [1,1]"), std::runtime_error);
+}
+
+TEST_F(GameTest, LoadEmptyFile) {
+    std::ofstream("test_save.txt").close();
+
+    EXPECT_EQ(game->LoadObjects("test_save.txt"), 0);
+    EXPECT_TRUE(game->QueryKNearest(Point(0, 0), 1).empty());
+}
+
 TEST_F(GameTest, SaveToNonexistentDirectory) {
     int32_t result = game->SaveObjects("/nonexistent/path/test.txt");
     EXPECT_NE(result, 0); // Ожидаем ошибку
@@ -127,6 +611,381 @@ TEST_F(GameTest, DumpObjects) {
     EXPECT_NE(output.find("25"), std::string::npos);
 }
 
+TEST_F(GameTest, ParallelDumpMatchesSerialFormat) {
+    std::ostringstream expected;
+
+    // Больше двух раундов форматирования на одного исполнителя
+    const auto COUNT = static_cast<int>(2 * Game::SAVE_CHUNK_SIZE + 7);
+
+    for (const auto &[type, point, name] : GenerateNPCs(COUNT, 501)) {
+        game->AddNPC(type, point, name);
+
+        expected << "[" << NPCTypeToString(type) << "] "
+                 << name << " [" << point.GetX() << "," << point.GetY() << "]" << std::endl;
+    }
+
+    for (std::size_t workers : { 0, 1, 2, 5, 2000 }) {
+        std::ostringstream actual;
+        game->DumpObjects(actual, workers);
+
+        EXPECT_EQ(actual.str(), expected.str()) << workers;
+    }
+}
+
+TEST_F(GameTest, AsyncSaveOutlivesGame) {
+    std::future<int32_t> saved;
+    std::ostringstream expected;
+
+    {
+        Game local(std::make_shared<NPCFactory>());
+
+        for (int i = 0; i < 1000; ++i) {
+            local.AddNPC(static_cast<NPCType>(i % 3), Point(i % 500, (i * 7) % 500), "NPC_" + std::to_string(i));
+        }
+
+        local.DumpObjects(expected);
+
+        saved = local.SaveObjectsAsync("test_save.txt");
+    }
+
+    ASSERT_EQ(saved.get(), 0);
+
+    std::ifstream file("test_save.txt");
+    std::stringstream actual;
+    actual << file.rdbuf();
+
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST_F(GameTest, AsyncSaveUsesSnapshot) {
+    game->AddNPC(NPCType::Druid, Point(1, 2), "Druid1");
+    game->AddNPC(NPCType::Werewolf, Point(3, 4), "Werewolf1");
+
+    std::ostringstream expected;
+    game->DumpObjects(expected);
+
+    auto saved = game->SaveObjectsAsync("test_save.txt");
+
+    game->AddNPC(NPCType::Squirrel, Point(5, 6), "Squirrel1");
+
+    ASSERT_EQ(saved.get(), 0);
+
+    std::ifstream file("test_save.txt");
+    std::stringstream actual;
+    actual << file.rdbuf();
+
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+auto CountOccurrences(const std::string &text,
+                      const std::string &pattern) -> std::size_t {
+    std::size_t count = 0;
+
+    for (auto position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1)) {
+        ++count;
+    }
+
+    return count;
+}
+
+TEST_F(GameTest, TracingDisabledRecordsNothing) {
+    Tracer::Get().Disable();
+    Tracer::Get().Clear();
+
+    game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+    game->AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+    game->StartBattle(5.0);
+
+    std::ostringstream trace;
+    Tracer::Get().Write(trace);
+
+    EXPECT_EQ(CountOccurrences(trace.str(), "\"ph\":\"X\""), 0);
+}
+
+TEST_F(GameTest, TracingRecordsBattlePhases) {
+    Tracer::Get().Clear();
+    Tracer::Get().Enable();
+
+    game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+    game->AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+    game->AddNPC(NPCType::Druid, Point(12, 12), "Druid2");
+    game->StartBattle(5.0);
+
+    Tracer::Get().Disable();
+
+    std::ostringstream trace;
+    Tracer::Get().Write(trace);
+    Tracer::Get().Clear();
+
+    auto json = trace.str();
+
+    EXPECT_TRUE(json.starts_with("{\"traceEvents\":["));
+    EXPECT_EQ(CountOccurrences(json, "\"name\":\"StartBattle\""), 1);
+    EXPECT_EQ(CountOccurrences(json, "\"name\":\"DumpObjects\""), 2);
+    EXPECT_EQ(CountOccurrences(json, "\"name\":\"PairEvaluation\""), 1);
+    EXPECT_EQ(CountOccurrences(json, "\"name\":\"KillResolution\""), 1);
+    EXPECT_EQ(CountOccurrences(json, "\"name\":\"Compaction\""), 1);
+    EXPECT_EQ(CountOccurrences(json, "\"name\":\"NotifyKill\""), 2);
+}
+
+TEST_F(GameTest, TracingRecordsLoadChunksPerThread) {
+    for (int i = 0; i < 30; ++i) {
+        game->AddNPC(static_cast<NPCType>(i % 3), Point(i, i), "NPC_" + std::to_string(i));
+    }
+
+    ASSERT_EQ(game->SaveObjects("test_save.txt"), 0);
+
+    Tracer::Get().Clear();
+    Tracer::Get().Enable();
+
+    Game loaded(std::make_shared<NPCFactory>());
+    ASSERT_EQ(loaded.LoadObjects("test_save.txt", 3), 0);
+
+    Tracer::Get().Disable();
+
+    std::ostringstream trace;
+    Tracer::Get().Write(trace);
+    Tracer::Get().Clear();
+
+    EXPECT_EQ(CountOccurrences(trace.str(), "\"name\":\"LoadObjects\""), 1);
+    EXPECT_EQ(CountOccurrences(trace.str(), "\"name\":\"ParseChunk\""), 3);
+}
+
+TEST_F(GameTest, ClearKeepsGameUsable) {
+    game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+    game->AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+
+    game->Clear();
+
+    EXPECT_EQ(game->CountNPCs(NPCType::Werewolf), 0);
+    EXPECT_EQ(game->CountNPCs(NPCType::Druid), 0);
+    EXPECT_TRUE(game->QueryRect(Point(0, 0), Point(500, 500)).empty());
+
+    // Имена очищенного мира снова свободны
+    EXPECT_EQ(game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1"), 0);
+    EXPECT_EQ(game->AddNPC(NPCType::Druid, Point(11, 11), "Druid1"), 0);
+
+    game->SetDumpStream(nullptr);
+    game->StartBattle(5.0);
+
+    EXPECT_EQ(game->CountNPCs(NPCType::Werewolf), 1);
+    EXPECT_EQ(game->CountNPCs(NPCType::Druid), 0);
+}
+
+TEST(BatchRunnerTest, MatchesSequentialGames) {
+    std::vector<ScenarioParameters> grid { { 40, 30.0 }, { 80, 10.0 } };
+
+    const std::size_t GAMES = 6;
+    const std::uint64_t SEED = 7;
+
+    // Каждая игра отдельно, как их запускают сейчас
+    std::vector<SurvivalStats> expected(grid.size());
+
+    for (std::size_t task = 0; task < grid.size() * GAMES; ++task) {
+        auto &stats = expected[task / GAMES];
+
+        Game game(std::make_shared<NPCFactory>());
+        game.SetDumpStream(nullptr);
+
+        std::mt19937_64 random(SEED + task);
+        GenerateUniformScenario(game, grid[task / GAMES], random);
+
+        for (std::size_t type = 0; type < NPC_TYPES_COUNT; ++type) {
+            stats.spawned[type] += game.CountNPCs(static_cast<NPCType>(type));
+        }
+
+        game.StartBattle(grid[task / GAMES].distance);
+
+        for (std::size_t type = 0; type < NPC_TYPES_COUNT; ++type) {
+            stats.survived[type] += game.CountNPCs(static_cast<NPCType>(type));
+        }
+    }
+
+    std::stringstream output;
+    auto *buffer = std::cout.rdbuf(output.rdbuf());
+
+    for (std::size_t workers : { 1, 3 }) {
+        auto report = BatchRunner(GenerateUniformScenario, workers).Run(grid, GAMES, SEED);
+
+        EXPECT_EQ(report.games, grid.size() * GAMES);
+        ASSERT_EQ(report.results.size(), grid.size());
+
+        for (std::size_t set = 0; set < grid.size(); ++set) {
+            EXPECT_EQ(report.results[set].games, GAMES);
+            EXPECT_EQ(report.results[set].stats.spawned, expected[set].spawned) << workers;
+            EXPECT_EQ(report.results[set].stats.survived, expected[set].survived) << workers;
+        }
+    }
+
+    std::cout.rdbuf(buffer);
+
+    // Бои в пакете ничего не выводят
+    EXPECT_TRUE(output.str().empty());
+}
+
+TEST_F(GameTest, ResumeFromEveryCheckpointMatchesFullBattle) {
+    PopulateWorld(*game, 200, 120);
+    game->SetDumpStream(nullptr);
+
+    ASSERT_EQ(game->SaveObjects("test_save.txt"), 0);
+
+    std::vector<BattleCheckpoint> checkpoints;
+
+    game->SetCheckpointHandler([&checkpoints] (const BattleCheckpoint &checkpoint) -> void {
+        checkpoints.push_back(checkpoint);
+    }, 16);
+
+    auto recorder = std::make_shared<KillRecorder>();
+    game->AddObserver(recorder);
+
+    game->StartBattle(10.0);
+
+    std::ostringstream expected;
+    game->DumpObjects(expected);
+
+    ASSERT_FALSE(recorder->kills.empty());
+
+    // Контрольные точки есть и при разборе пар, и при оповещении наблюдателей
+    EXPECT_TRUE(std::ranges::any_of(checkpoints, [] (const BattleCheckpoint &checkpoint) -> bool {
+        return checkpoint.defender < checkpoint.npcs;
+    }));
+    EXPECT_TRUE(std::ranges::any_of(checkpoints, [] (const BattleCheckpoint &checkpoint) -> bool {
+        return checkpoint.notified != 0;
+    }));
+
+    for (const auto &checkpoint : checkpoints) {
+        // Точка проходит через текстовый формат, как при записи на диск
+        std::stringstream stream;
+        checkpoint.Save(stream);
+
+        Game resumed(std::make_shared<NPCFactory>());
+        resumed.SetDumpStream(nullptr);
+
+        ASSERT_EQ(resumed.LoadObjects("test_save.txt"), 0);
+
+        auto resumed_recorder = std::make_shared<KillRecorder>();
+        resumed.AddObserver(resumed_recorder);
+
+        ASSERT_EQ(resumed.ResumeBattle(BattleCheckpoint::Load(stream)), 0);
+
+        std::vector<std::string> expected_kills(recorder->kills.begin() + static_cast<std::ptrdiff_t>(checkpoint.notified),
+                                                recorder->kills.end());
+
+        EXPECT_EQ(resumed_recorder->kills, expected_kills) << checkpoint.defender << " " << checkpoint.notified;
+
+        std::ostringstream actual;
+        resumed.DumpObjects(actual);
+
+        EXPECT_EQ(actual.str(), expected.str());
+    }
+}
+
+TEST_F(GameTest, ResumeAfterInterruptedBattle) {
+    PopulateWorld(*game, 200, 120);
+    game->SetDumpStream(nullptr);
+
+    ASSERT_EQ(game->SaveObjects("test_save.txt"), 0);
+
+    // Бой прерывается на третьей контрольной точке, успев записать её
+    std::size_t count = 0;
+
+    game->SetCheckpointHandler([&count] (const BattleCheckpoint &checkpoint) -> void {
+        ASSERT_EQ(checkpoint.SaveFile("test_checkpoint.txt"), 0);
+
+        if (++count == 3) {
+            throw std::runtime_error("interrupted");
+        }
+    }, 20);
+
+    EXPECT_THROW(game->StartBattle(10.0), std::runtime_error);
+
+    Game uninterrupted(std::make_shared<NPCFactory>());
+    uninterrupted.SetDumpStream(nullptr);
+    ASSERT_EQ(uninterrupted.LoadObjects("test_save.txt"), 0);
+    uninterrupted.StartBattle(10.0);
+
+    Game resumed(std::make_shared<NPCFactory>());
+    resumed.SetDumpStream(nullptr);
+    ASSERT_EQ(resumed.LoadObjects("test_save.txt"), 0);
+
+    ASSERT_EQ(resumed.ResumeBattle(BattleCheckpoint::LoadFile("test_checkpoint.txt")), 0);
+
+    std::ostringstream expected, actual;
+    uninterrupted.DumpObjects(expected);
+    resumed.DumpObjects(actual);
+
+    EXPECT_EQ(actual.str(), expected.str());
+
+    std::remove("test_checkpoint.txt");
+}
+
+TEST_F(GameTest, BattleAfterInterruptedNotificationSkipsKilled) {
+    game->SetDumpStream(nullptr);
+
+    game->AddNPC(NPCType::Werewolf, Point(11, 11), "W");
+    game->AddNPC(NPCType::Squirrel, Point(10, 10), "S");
+    game->AddNPC(NPCType::Druid, Point(12, 12), "D");
+
+    auto recorder = std::make_shared<KillRecorder>();
+    game->AddObserver(recorder);
+
+    // Бой прерывается после первого оповещения, убитые ещё не удалены из мира
+    game->SetCheckpointHandler([] (const BattleCheckpoint &checkpoint) -> void {
+        if (checkpoint.notified == 1) {
+            throw std::runtime_error("interrupted");
+        }
+    }, 1);
+
+    EXPECT_THROW(game->StartBattle(5.0), std::runtime_error);
+
+    ASSERT_EQ(recorder->kills, std::vector<std::string> { "[W] killed by [S]!" });
+
+    game->SetCheckpointHandler(nullptr, 0);
+    game->StartBattle(5.0);
+
+    // Уже убитый NPC не погибает повторно и удаляется из мира
+    EXPECT_EQ(std::ranges::count(recorder->kills, "[W] killed by [S]!"), 1);
+
+    std::ostringstream output;
+    game->DumpObjects(output);
+
+    EXPECT_EQ(output.str().find(" W "), std::string::npos);
+}
+
+TEST_F(GameTest, ResumeRejectsDifferentWorld) {
+    PopulateWorld(*game, 200, 120);
+    game->SetDumpStream(nullptr);
+
+    std::vector<BattleCheckpoint> checkpoints;
+
+    game->SetCheckpointHandler([&checkpoints] (const BattleCheckpoint &checkpoint) -> void {
+        checkpoints.push_back(checkpoint);
+    }, 50);
+
+    game->StartBattle(10.0);
+
+    ASSERT_FALSE(checkpoints.empty());
+
+    Game other(std::make_shared<NPCFactory>());
+    other.SetDumpStream(nullptr);
+    PopulateWorld(other, 200, 120);
+    other.AddNPC(NPCType::Druid, Point(500, 500), "Extra");
+
+    EXPECT_EQ(other.ResumeBattle(checkpoints.front()), 1);
+
+    std::istringstream malformed("checkpoint 0 100 5 1\ncursor 2 0\nkills 3\n0 1\n");
+
+    EXPECT_THROW(BattleCheckpoint::Load(malformed), std::runtime_error);
+
+    std::istringstream huge_count("checkpoint 0 100 5 1\ncursor 2 0\nkills 18446744073709551615\n0 1\n");
+
+    EXPECT_THROW(BattleCheckpoint::Load(huge_count), std::runtime_error);
+
+    std::istringstream huge_world("checkpoint 0 100 18446744073709551615 1\ncursor 2 0\nkills 4000000000000\n0 1\n");
+
+    EXPECT_THROW(BattleCheckpoint::Load(huge_world), std::runtime_error);
+}
+
 // Тесты для Observer
 TEST_F(GameTest, ObserverRegistration) {
     auto screenObserver = std::make_shared<Screen>();
@@ -151,7 +1010,147 @@ TEST_F(GameTest, ScreenObserver) {
 
     // Этот тест в основном проверяет, что нет crash при вызове
     // Для полного тестирования нужно перехватывать stdout
-    EXPECT_NO_THROW(screenObserver->OnKill(*npc1, *npc2));
+    EXPECT_NO_THROW(screenObserver->OnKill(*npc1, *npc2, factory->GetNames()));
+}
+
+// Наблюдатель пишет в общий журнал, чтобы проверить и порядок оповещения
+class SharedLogObserver : public Observer {
+public:
+    SharedLogObserver(std::size_t id,
+                      std::vector<std::string> &log)
+            : id(id),
+              log(log) {}
+
+    auto OnKill(const NPC &killer,
+                const NPC &killed,
+
+                const NameTable &names) -> void override {
+        log.push_back(std::to_string(id) + ": " + OnKillMessage(killer, killed, names));
+    }
+
+    std::size_t id;
+    std::vector<std::string> &log;
+};
+
+TEST_F(GameTest, FilteredObserversMatchBruteForce) {
+    PopulateWorld(*game, 300, 200);
+
+    std::vector<ObserverFilter> filters {
+        ObserverFilter(),
+        ObserverFilter { NPCTypeMask(NPCType::Werewolf), NPCTypeMask(NPCType::Druid), std::nullopt },
+        ObserverFilter { ALL_NPC_TYPES, ALL_NPC_TYPES, KillRegion { Point(20, 30), Point(120, 90) } },
+        ObserverFilter { NPCTypeMask(NPCType::Squirrel), ALL_NPC_TYPES, KillRegion { Point(0, 0), Point(60, 200) } },
+        ObserverFilter { NPCTypeMask(NPCType::Druid), ALL_NPC_TYPES, std::nullopt },
+        ObserverFilter { ALL_NPC_TYPES, NPCTypeMask(NPCType::Werewolf), KillRegion { Point(150, 150), Point(1000, 1000) } }
+    };
+
+    std::vector<std::string> log;
+
+    for (std::size_t id = 0; id < filters.size(); ++id) {
+        game->AddObserver(std::make_shared<SharedLogObserver>(id, log), filters[id]);
+    }
+
+    // Полный журнал: (убийца, жертва) для каждого убийства
+    struct Kill {
+        NPCType killer;
+        NPCType victim;
+        Point point;
+        std::string message;
+    };
+
+    std::vector<Kill> kills;
+
+    class FullRecorder : public Observer {
+    public:
+        explicit FullRecorder(std::vector<Kill> &kills)
+                : kills(kills) {}
+
+        auto OnKill(const NPC &killer,
+                    const NPC &killed,
+
+                    const NameTable &names) -> void override {
+            kills.push_back(Kill { killer.GetType(), killed.GetType(), killed.GetPoint(), OnKillMessage(killer, killed, names) });
+        }
+
+        std::vector<Kill> &kills;
+    };
+
+    game->AddObserver(std::make_shared<FullRecorder>(kills));
+
+    game->StartBattle(15.0);
+
+    ASSERT_FALSE(kills.empty());
+
+    std::vector<std::string> expected;
+
+    for (const auto &kill : kills) {
+        for (std::size_t id = 0; id < filters.size(); ++id) {
+            const auto &filter = filters[id];
+
+            if (!(filter.killers & NPCTypeMask(kill.killer)) || !(filter.victims & NPCTypeMask(kill.victim))) {
+                continue;
+            }
+
+            if (filter.region && !filter.region->Contains(kill.point)) {
+                continue;
+            }
+
+            expected.push_back(std::to_string(id) + ": " + kill.message);
+        }
+    }
+
+    EXPECT_EQ(log, expected);
+    EXPECT_LT(log.size(), kills.size() * filters.size());
+}
+
+TEST_F(GameTest, ScreenFullMode) {
+    std::ostringstream output;
+    auto screen = std::make_shared<Screen>(ScreenMode::Full, 0, output);
+    game->AddObserver(screen);
+
+    game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+    game->AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+    game->AddNPC(NPCType::Druid, Point(12, 12), "Druid2");
+
+    game->StartBattle(5.0);
+
+    EXPECT_EQ(output.str(), "[Druid1] killed by [Werewolf1]!\n[Druid2] killed by [Werewolf1]!\n");
+}
+
+TEST_F(GameTest, ScreenSummaryMode) {
+    std::ostringstream output;
+    auto screen = std::make_shared<Screen>(ScreenMode::Summary, 0, output);
+    game->AddObserver(screen);
+
+    game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+    game->AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+    game->AddNPC(NPCType::Druid, Point(20, 20), "Druid2");
+    game->AddNPC(NPCType::Squirrel, Point(23, 23), "Squirrel1");
+
+    game->StartBattle(5.0);
+
+    EXPECT_EQ(output.str(), "Battle summary:\n"
+                            "  [Squirrel] killed [Druid]: 1\n"
+                            "  [Werewolf] killed [Druid]: 1\n"
+                            "  Total kills: 2\n");
+}
+
+TEST_F(GameTest, ScreenSampledMode) {
+    std::ostringstream output;
+    Screen screen(ScreenMode::Sampled, 2, output);
+
+    auto killer = factory->CreateNPC(NPCType::Werewolf, Point(1, 1), "Attacker");
+    auto killed = factory->CreateNPC(NPCType::Druid, Point(2, 2), "Victim");
+
+    for (int i = 0; i < 5; ++i) {
+        screen.OnKill(*killer, *killed, factory->GetNames());
+    }
+
+    screen.OnBattleEnd();
+
+    EXPECT_EQ(output.str(), "[Victim] killed by [Attacker]!\n"
+                            "[Victim] killed by [Attacker]!\n"
+                            "... 3 more kills not shown\n");
 }
 
 TEST_F(GameTest, FileObserver) {
@@ -164,7 +1163,7 @@ TEST_F(GameTest, FileObserver) {
     auto npc1 = factory->CreateNPC(NPCType::Werewolf, point1, "Attacker");
     auto npc2 = factory->CreateNPC(NPCType::Druid, point2, "Victim");
 
-    fileObserver->OnKill(*npc1, *npc2);
+    fileObserver->OnKill(*npc1, *npc2, factory->GetNames());
 
     // Проверяем, что файл создан и содержит ожидаемый текст
     std::ifstream checkFile("test_log.txt");
@@ -230,6 +1229,145 @@ TEST_F(GameTest, BattleMultipleNPCs) {
     EXPECT_GE(result, 0);
 }
 
+TEST_F(GameTest, RepeatedBattleOnStableWorldIsSkipped) {
+    game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+    game->AddNPC(NPCType::Druid, Point(12, 12), "Druid1");
+    game->AddNPC(NPCType::Druid, Point(200, 200), "Druid2");
+
+    auto generation = game->GetGeneration();
+
+    testing::internal::CaptureStdout();
+    game->StartBattle(5.0);
+    EXPECT_FALSE(testing::internal::GetCapturedStdout().empty());
+    EXPECT_NE(game->GetGeneration(), generation);
+
+    generation = game->GetGeneration();
+
+    testing::internal::CaptureStdout();
+    EXPECT_EQ(game->StartBattle(5.0), 0);
+    EXPECT_EQ(game->StartBattle(3.0), 0);
+    EXPECT_TRUE(testing::internal::GetCapturedStdout().empty());
+    EXPECT_EQ(game->GetGeneration(), generation);
+
+    game->AddNPC(NPCType::Druid, Point(11, 11), "Druid3");
+
+    testing::internal::CaptureStdout();
+    game->StartBattle(5.0);
+    EXPECT_FALSE(testing::internal::GetCapturedStdout().empty());
+}
+
+TEST_F(GameTest, GrowingDistanceMatchesFullBattle) {
+    PopulateWorld(*game, 200, 120);
+
+    Game reference(factory);
+    PopulateWorld(reference, 200, 120);
+
+    game->StartBattle(4.0);
+    game->StartBattle(9.0);
+
+    reference.StartBattle(4.0);
+
+    // Эталонный мир забывает о своей устойчивости, пересобираясь из сохранения
+    ASSERT_EQ(reference.SaveObjects("test_save.txt"), 0);
+
+    Game rebuilt(factory);
+    ASSERT_EQ(rebuilt.LoadObjects("test_save.txt"), 0);
+    rebuilt.StartBattle(9.0);
+
+    std::stringstream actual, expected;
+    game->DumpObjects(actual);
+    rebuilt.DumpObjects(expected);
+
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST_F(GameTest, IncrementalBattleMatchesFullBattle) {
+    auto incremental_log = std::make_shared<KillRecorder>();
+    game->AddObserver(incremental_log);
+
+    auto added = GenerateNPCs(150, 90);
+
+    std::size_t next = 0;
+
+    for (int round = 0; round < 10; ++round) {
+        for (std::size_t count = round == 0 ? 100 : 5; count > 0; --count, ++next) {
+            auto &[type, point, name] = added[next];
+
+            game->AddNPC(type, point, name);
+        }
+
+        // Эталон: новый мир с теми же NPC и полным боем
+        ASSERT_EQ(game->SaveObjects("test_save.txt"), 0);
+
+        Game full(factory);
+        auto full_log = std::make_shared<KillRecorder>();
+        full.AddObserver(full_log);
+        ASSERT_EQ(full.LoadObjects("test_save.txt"), 0);
+
+        incremental_log->kills.clear();
+
+        game->StartBattle(6.0);
+        full.StartBattle(6.0);
+
+        std::stringstream actual, expected;
+        game->DumpObjects(actual);
+        full.DumpObjects(expected);
+
+        EXPECT_EQ(actual.str(), expected.str());
+        EXPECT_EQ(incremental_log->kills, full_log->kills);
+    }
+}
+
+template<typename Metric>
+auto ExpectRangeBoundMatchesInRange(double distance) -> void {
+    auto bound = RangeBound<Metric>(distance);
+
+    auto check = [bound, distance] (std::uint64_t first, std::uint64_t last) -> void {
+        for (auto measure = first; measure <= std::min(last, Metric::MAX_DISTANCE); ++measure) {
+            ASSERT_EQ(measure < bound, InRange<Metric>(measure, distance)) << distance << " " << measure;
+        }
+    };
+
+    check(0, 1000);
+    check(bound > 1000 ? bound - 1000 : 0, bound + 1000);
+    check(Metric::MAX_DISTANCE - 10, Metric::MAX_DISTANCE);
+}
+
+TEST(MetricTest, RangeBoundMatchesInRange) {
+    for (double distance : { -1.0, 0.0, 1e-10, 1.0, 1.0 + 1e-12, 2.5, 10.0, 123.456, 707.2, 40000.5, 1e9 }) {
+        ExpectRangeBoundMatchesInRange<EuclideanMetric>(distance);
+        ExpectRangeBoundMatchesInRange<ManhattanMetric>(distance);
+        ExpectRangeBoundMatchesInRange<ChebyshevMetric>(distance);
+    }
+}
+
+TEST(MetricTest, Distances) {
+    Point first(3, 10), second(7, 5);
+
+    EXPECT_EQ(EuclideanMetric::Distance(first, second), 41);
+    EXPECT_EQ(ManhattanMetric::Distance(first, second), 9);
+    EXPECT_EQ(ChebyshevMetric::Distance(first, second), 5);
+}
+
+TEST_F(GameTest, EuclideanBattleMatchesReference) {
+    ExpectBattleMatchesReference<EuclideanMetric>(factory, 7.0);
+}
+
+TEST_F(GameTest, ManhattanBattleMatchesReference) {
+    ExpectBattleMatchesReference<ManhattanMetric>(factory, 9.0);
+}
+
+TEST_F(GameTest, ChebyshevBattleMatchesReference) {
+    ExpectBattleMatchesReference<ChebyshevMetric>(factory, 6.0);
+}
+
+TEST_F(GameTest, SameTypeRulesBattleMatchesReference) {
+    // NPC одного типа убивают друг друга, но не самих себя
+    std::istringstream file("Druid Druid kills\nWerewolf Werewolf kills\nDruid Squirrel kills\n");
+
+    ExpectBattleMatchesReference<EuclideanMetric>(factory, 7.0, BattleRules::Load(file));
+}
+
 // Тесты для правил атаки (на основе варианта 8)
 TEST_F(GameTest, AttackRulesSquirrelVsWerewolf) {
     Point point1(10, 10);
@@ -288,6 +1426,110 @@ TEST_F(GameTest, AttackDistanceCheck) {
     EXPECT_FALSE(squirrel->CanAttack(*werewolf, 10.0));
 }
 
+TEST(BattleRulesTest, DefaultRules) {
+    BattleRules rules;
+
+    EXPECT_TRUE(rules.CanKill(NPCType::Squirrel, NPCType::Werewolf));
+    EXPECT_TRUE(rules.CanKill(NPCType::Squirrel, NPCType::Druid));
+    EXPECT_FALSE(rules.CanKill(NPCType::Squirrel, NPCType::Squirrel));
+    EXPECT_TRUE(rules.CanKill(NPCType::Werewolf, NPCType::Druid));
+    EXPECT_FALSE(rules.CanKill(NPCType::Werewolf, NPCType::Werewolf));
+    EXPECT_FALSE(rules.CanKill(NPCType::Werewolf, NPCType::Squirrel));
+    EXPECT_FALSE(rules.CanKill(NPCType::Druid, NPCType::Druid));
+    EXPECT_FALSE(rules.CanKill(NPCType::Druid, NPCType::Squirrel));
+    EXPECT_FALSE(rules.CanKill(NPCType::Druid, NPCType::Werewolf));
+
+    EXPECT_EQ(rules.GetAttackers(NPCType::Squirrel), 0);
+}
+
+TEST(BattleRulesTest, LoadOverridesDefaults) {
+    std::istringstream file("# Balance patch\n"
+                            "\n"
+                            "Druid Squirrel kills\n"
+                            "Squirrel Werewolf spares\n");
+
+    auto rules = BattleRules::Load(file);
+
+    EXPECT_TRUE(rules.CanKill(NPCType::Druid, NPCType::Squirrel));
+    EXPECT_FALSE(rules.CanKill(NPCType::Squirrel, NPCType::Werewolf));
+    EXPECT_TRUE(rules.CanKill(NPCType::Werewolf, NPCType::Druid));
+}
+
+TEST(BattleRulesTest, LoadRejectsUnknownType) {
+    std::istringstream file("Dragon Druid kills\n");
+
+    try {
+        BattleRules::Load(file);
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch (const std::runtime_error &error) {
+        EXPECT_NE(std::string(error.what()).find("'Dragon'"), std::string::npos);
+        EXPECT_NE(std::string(error.what()).find("line 1"), std::string::npos);
+    }
+}
+
+TEST(BattleRulesTest, LoadRejectsMalformedLine) {
+    std::istringstream missing("Druid Squirrel\n");
+    std::istringstream verdict("Druid Squirrel eats\n");
+
+    EXPECT_THROW(BattleRules::Load(missing), std::runtime_error);
+    EXPECT_THROW(BattleRules::Load(verdict), std::runtime_error);
+    EXPECT_THROW(BattleRules::LoadFile("nonexistent_rules.txt"), std::runtime_error);
+}
+
+TEST_F(GameTest, BattleUsesCustomRules) {
+    std::istringstream file("Druid Squirrel kills\n");
+
+    Game custom(factory, BattleRules::Load(file));
+
+    custom.AddNPC(NPCType::Squirrel, Point(10, 10), "Squirrel1");
+    custom.AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+
+    custom.StartBattle(10.0);
+
+    auto survivors = custom.QueryRect(Point(0, 0), Point(MAX_COORDINATE, MAX_COORDINATE));
+
+    ASSERT_EQ(survivors.size(), 1);
+    EXPECT_EQ(custom.GetName(*survivors[0]), "Druid1");
+}
+
+TEST_F(GameTest, SameTypeRuleDoesNotKillLoneNPCs) {
+    std::istringstream file("Druid Druid kills\n");
+
+    Game custom(factory, BattleRules::Load(file));
+
+    custom.AddNPC(NPCType::Druid, Point(10, 10), "DruidA");
+    custom.AddNPC(NPCType::Druid, Point(137, 10), "DruidB");
+
+    custom.StartBattle(5.0);
+
+    EXPECT_EQ(custom.QueryRect(Point(0, 0), Point(MAX_COORDINATE, MAX_COORDINATE)).size(), 2);
+
+    custom.AddNPC(NPCType::Druid, Point(12, 10), "DruidC");
+
+    custom.StartBattle(5.0);
+
+    auto survivors = custom.QueryRect(Point(0, 0), Point(MAX_COORDINATE, MAX_COORDINATE));
+
+    // Защитник DruidA идёт первым и погибает от DruidC
+    ASSERT_EQ(survivors.size(), 2);
+    EXPECT_EQ(custom.GetName(*survivors[0]), "DruidB");
+    EXPECT_EQ(custom.GetName(*survivors[1]), "DruidC");
+}
+
+TEST_F(GameTest, DruidsNeverAttack) {
+    game->AddNPC(NPCType::Druid, Point(10, 10), "Druid1");
+    game->AddNPC(NPCType::Werewolf, Point(11, 11), "Werewolf1");
+    game->AddNPC(NPCType::Squirrel, Point(12, 12), "Squirrel1");
+
+    game->StartBattle(10.0);
+
+    auto survivors = game->QueryRect(Point(0, 0), Point(MAX_COORDINATE, MAX_COORDINATE));
+
+    ASSERT_EQ(survivors.size(), 1);
+    EXPECT_EQ(game->GetName(*survivors[0]), "Squirrel1");
+}
+
 // Тесты для Visitor (Battle)
 TEST_F(GameTest, BattleVisitorCreation) {
     Battle battle(*game);
@@ -303,6 +1545,89 @@ TEST_F(GameTest, BattleVisitorSetTarget) {
     EXPECT_NO_THROW(battle.SetTarget(target));
 }
 
+// Тесты для пространственных запросов
+TEST_F(GameTest, QueryRect) {
+    game->AddNPC(NPCType::Druid, Point(10, 10), "Inside1");
+    game->AddNPC(NPCType::Druid, Point(20, 30), "Inside2");
+    game->AddNPC(NPCType::Druid, Point(21, 30), "Outside");
+
+    auto npcs = game->QueryRect(Point(5, 5), Point(20, 30));
+
+    ASSERT_EQ(npcs.size(), 2);
+    EXPECT_EQ(game->GetName(*npcs[0]), "Inside1");
+    EXPECT_EQ(game->GetName(*npcs[1]), "Inside2");
+}
+
+TEST_F(GameTest, QueryRadiusMatchesBruteForce) {
+    std::vector<Point> points;
+
+    for (int i = 0; i < 300; ++i) {
+        Point point((i * 37) % 501, (i * 91) % 501);
+
+        points.push_back(point);
+        game->AddNPC(NPCType::Druid, point, "NPC_" + std::to_string(i));
+    }
+
+    Point center(250, 250);
+    double radius = 60.5;
+
+    std::size_t expected = 0;
+
+    for (const auto &point : points) {
+        if (static_cast<double>(EuclideanMetric::Distance(center, point)) <= radius * radius) {
+            ++expected;
+        }
+    }
+
+    auto npcs = game->QueryRadius(center, radius);
+
+    EXPECT_EQ(npcs.size(), expected);
+
+    for (const auto *npc : npcs) {
+        EXPECT_LE(static_cast<double>(EuclideanMetric::Distance(center, npc->GetPoint())), radius * radius);
+    }
+}
+
+TEST_F(GameTest, QueryKNearest) {
+    game->AddNPC(NPCType::Druid, Point(100, 100), "Far");
+    game->AddNPC(NPCType::Druid, Point(0, 3), "Second");
+    game->AddNPC(NPCType::Druid, Point(1, 1), "First");
+    game->AddNPC(NPCType::Druid, Point(40, 0), "Third");
+
+    auto npcs = game->QueryKNearest(Point(0, 0), 3);
+
+    ASSERT_EQ(npcs.size(), 3);
+    EXPECT_EQ(game->GetName(*npcs[0]), "First");
+    EXPECT_EQ(game->GetName(*npcs[1]), "Second");
+    EXPECT_EQ(game->GetName(*npcs[2]), "Third");
+
+    EXPECT_EQ(game->QueryKNearest(Point(0, 0), 10).size(), 4);
+    EXPECT_TRUE(game->QueryKNearest(Point(0, 0), 0).empty());
+}
+
+TEST_F(GameTest, QueryAfterBattleAndLoad) {
+    game->AddNPC(NPCType::Werewolf, Point(10, 10), "Werewolf1");
+    game->AddNPC(NPCType::Druid, Point(11, 11), "Druid1");
+    game->AddNPC(NPCType::Squirrel, Point(300, 300), "Squirrel1");
+
+    game->StartBattle(5.0);
+
+    auto npcs = game->QueryRadius(Point(10, 10), 5.0);
+
+    ASSERT_EQ(npcs.size(), 1);
+    EXPECT_EQ(game->GetName(*npcs[0]), "Werewolf1");
+
+    ASSERT_EQ(game->SaveObjects("test_save.txt"), 0);
+
+    Game loaded(factory);
+    ASSERT_EQ(loaded.LoadObjects("test_save.txt"), 0);
+
+    auto nearest = loaded.QueryKNearest(Point(290, 290), 1);
+
+    ASSERT_EQ(nearest.size(), 1);
+    EXPECT_EQ(loaded.GetName(*nearest[0]), "Squirrel1");
+}
+
 // Тесты для NPCType conversions
 TEST(NPCTypeTest, TypeToStringConversion) {
     EXPECT_EQ(NPCTypeToString(NPCType::Squirrel), "Squirrel");
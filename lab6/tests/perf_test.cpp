@@ -0,0 +1,312 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <lab6/batch.h>
+#include <lab6/game.h>
+
+
+// Времена сценариев сравниваются с сохранёнными базовыми значениями:
+// тест падает, если сценарий стал медленнее базового больше чем в LAB6_PERF_TOLERANCE раз.
+// LAB6_PERF_UPDATE=1 перезаписывает базовые значения измеренными.
+
+#ifndef LAB6_PERF_BASELINES
+#define LAB6_PERF_BASELINES "perf_baselines.txt"
+#endif
+
+const double DEFAULT_TOLERANCE = 3.0;
+
+// Короткие сценарии сравниваются не точнее, чем с этим временем, иначе решает шум
+const double MIN_BASELINE_SECONDS = 0.05;
+
+class NullBuffer : public std::streambuf {
+protected:
+    auto overflow(int_type character) -> int_type override {
+        return traits_type::not_eof(character);
+    }
+
+    auto xsputn(const char_type *, std::streamsize count) -> std::streamsize override {
+        return count;
+    }
+};
+
+class Baselines {
+public:
+    Baselines() {
+        std::ifstream file(LAB6_PERF_BASELINES);
+
+        std::string line;
+
+        while (std::getline(file, line)) {
+            if (line.empty() || line.starts_with("#")) {
+                continue;
+            }
+
+            std::istringstream record(line);
+
+            std::string name;
+            double seconds;
+
+            if (record >> name >> seconds) {
+                _seconds[name] = seconds;
+            }
+        }
+    }
+
+    ~Baselines() {
+        if (!Update()) {
+            return;
+        }
+
+        std::ofstream file(LAB6_PERF_BASELINES);
+
+        file << "# scenario seconds, recorded with the default build configuration\n";
+
+        for (const auto &[name, seconds] : _seconds) {
+            file << name << " " << seconds << "\n";
+        }
+    }
+
+    static auto Update() -> bool {
+        const char *update = std::getenv("LAB6_PERF_UPDATE");
+
+        return update != nullptr && std::string(update) == "1";
+    }
+
+    static auto Tolerance() -> double {
+        const char *tolerance = std::getenv("LAB6_PERF_TOLERANCE");
+
+        return tolerance != nullptr ? std::atof(tolerance) : DEFAULT_TOLERANCE;
+    }
+
+    auto Check(const std::string &name,
+               double seconds) -> void {
+        if (Update()) {
+            _seconds[name] = seconds;
+
+            return;
+        }
+
+        auto it = _seconds.find(name);
+
+        if (it == _seconds.end()) {
+            ADD_FAILURE() << "No baseline for scenario '" << name << "' in " << LAB6_PERF_BASELINES
+                          << ", run with LAB6_PERF_UPDATE=1 to record it";
+
+            return;
+        }
+
+        auto limit = std::max(it->second, MIN_BASELINE_SECONDS) * Tolerance();
+
+        EXPECT_LE(seconds, limit) << "Scenario '" << name << "' regressed: " << seconds
+                                  << " s against a baseline of " << it->second << " s";
+    }
+
+private:
+    std::map<std::string, double> _seconds;
+};
+
+auto GetBaselines() -> Baselines & {
+    static Baselines baselines;
+
+    return baselines;
+}
+
+// Пиковое потребление памяти процессом (VmHWM) сбрасывается до текущего (VmRSS) перед каждым сценарием.
+// Память, оставленная аллокатором от предыдущих тестов, остаётся в RSS, поэтому сценарии
+// запускаются в отдельных процессах, а рост памяти за сценарий записывается отдельно
+auto ResetPeakMemory() -> void {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+auto GetMemoryKb(const std::string &field) -> std::size_t {
+    std::ifstream status("/proc/self/status");
+
+    std::string line;
+
+    while (std::getline(status, line)) {
+        if (line.starts_with(field)) {
+            return std::strtoull(line.c_str() + field.size(), nullptr, 10);
+        }
+    }
+
+    return 0;
+}
+
+auto RunScenario(const std::string &name,
+                 std::size_t npcs,
+                 const std::function<void()> &scenario) -> void {
+    ResetPeakMemory();
+
+    auto start_memory = GetMemoryKb("VmRSS:");
+
+    // Дампы мира в StartBattle не должны упираться в терминал
+    NullBuffer null_buffer;
+    auto *buffer = std::cout.rdbuf(&null_buffer);
+
+    auto start = std::chrono::steady_clock::now();
+    scenario();
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout.rdbuf(buffer);
+
+    auto seconds = std::chrono::duration<double>(end - start).count();
+    auto peak    = GetMemoryKb("VmHWM:");
+    auto growth  = peak > start_memory ? peak - start_memory : 0;
+
+    std::cout << "[ PERF     ] " << name << ": " << seconds << " s, "
+              << static_cast<double>(npcs) / seconds << " NPC/s, peak " << peak << " KB, "
+              << growth << " KB over the start" << std::endl;
+
+    testing::Test::RecordProperty("seconds", std::to_string(seconds));
+    testing::Test::RecordProperty("peak_memory_kb", std::to_string(peak));
+    testing::Test::RecordProperty("scenario_memory_kb", std::to_string(growth));
+
+    GetBaselines().Check(name, seconds);
+}
+
+// Мир из count NPC по фиксированному зерну; mt19937_64 одинаков на всех платформах
+auto GenerateWorld(Game &game,
+                   std::size_t count,
+                   std::uint64_t seed) -> void {
+    std::mt19937_64 random(seed);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        auto type = static_cast<NPCType>(random() % NPC_TYPES_COUNT);
+        Point point(random() % (MAX_COORDINATE + 1), random() % (MAX_COORDINATE + 1));
+
+        game.AddNPC(type, point, "NPC_" + std::to_string(i));
+    }
+}
+
+class PerformanceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        factory = std::make_shared<NPCFactory>();
+        game = std::make_unique<Game>(factory);
+    }
+
+    void TearDown() override {
+        std::remove("perf_save.txt");
+    }
+
+    std::shared_ptr<NPCFactory> factory;
+    std::unique_ptr<Game> game;
+};
+
+TEST_F(PerformanceTest, Battle10k) {
+    GenerateWorld(*game, 10'000, 10);
+
+    RunScenario("battle_10k", 10'000, [this] () {
+        game->StartBattle(20.0);
+    });
+}
+
+TEST_F(PerformanceTest, Battle100k) {
+    GenerateWorld(*game, 100'000, 100);
+
+    RunScenario("battle_100k", 100'000, [this] () {
+        game->StartBattle(10.0);
+    });
+}
+
+TEST_F(PerformanceTest, Battle1M) {
+    GenerateWorld(*game, 1'000'000, 1000);
+
+    RunScenario("battle_1m", 1'000'000, [this] () {
+        game->StartBattle(3.0);
+    });
+}
+
+TEST_F(PerformanceTest, RepeatedBattle1M) {
+    GenerateWorld(*game, 1'000'000, 1001);
+
+    NullBuffer null_buffer;
+    auto *buffer = std::cout.rdbuf(&null_buffer);
+    game->StartBattle(3.0);
+    std::cout.rdbuf(buffer);
+
+    RunScenario("repeated_battle_1m", 1'000'000, [this] () {
+        for (int i = 0; i < 100; ++i) {
+            game->StartBattle(3.0);
+        }
+    });
+}
+
+TEST_F(PerformanceTest, IncrementalBattle100k) {
+    GenerateWorld(*game, 100'000, 102);
+
+    NullBuffer null_buffer;
+    auto *buffer = std::cout.rdbuf(&null_buffer);
+    game->StartBattle(10.0);
+    std::cout.rdbuf(buffer);
+
+    RunScenario("incremental_battle_100k", 100'000, [this] () {
+        std::mt19937_64 random(103);
+
+        for (int round = 0; round < 10; ++round) {
+            for (int i = 0; i < 10; ++i) {
+                Point point(random() % (MAX_COORDINATE + 1), random() % (MAX_COORDINATE + 1));
+
+                game->AddNPC(static_cast<NPCType>(random() % NPC_TYPES_COUNT), point,
+                             "New_" + std::to_string(round) + "_" + std::to_string(i));
+            }
+
+            game->StartBattle(10.0);
+        }
+    });
+}
+
+TEST_F(PerformanceTest, Save1M) {
+    GenerateWorld(*game, 1'000'000, 1002);
+
+    RunScenario("save_1m", 1'000'000, [this] () {
+        ASSERT_EQ(game->SaveObjects("perf_save.txt"), 0);
+    });
+}
+
+TEST_F(PerformanceTest, Load1M) {
+    GenerateWorld(*game, 1'000'000, 1003);
+
+    ASSERT_EQ(game->SaveObjects("perf_save.txt"), 0);
+
+    Game loaded(factory);
+
+    RunScenario("load_1m", 1'000'000, [&loaded] () {
+        ASSERT_EQ(loaded.LoadObjects("perf_save.txt"), 0);
+    });
+
+    std::ostringstream expected, actual;
+    game->DumpObjects(expected);
+    loaded.DumpObjects(actual);
+
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST(BatchPerformanceTest, Batch200Games) {
+    std::vector<ScenarioParameters> grid { { 1'000, 10.0 }, { 1'000, 30.0 } };
+
+    BatchReport report;
+
+    RunScenario("batch_200_games", 200'000, [&grid, &report] () {
+        report = BatchRunner().Run(grid, 100, 2000);
+    });
+
+    std::cout << "[ PERF     ] batch_200_games: " << report.GetGamesPerSecond() << " games/s" << std::endl;
+
+    EXPECT_EQ(report.games, 200);
+}
+
+int main(int argc,
+         char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}